@@ -0,0 +1,278 @@
+#define _POSIX_C_SOURCE 200809L
+#include "bench_corpus.h"
+#include "ui/ui_app_cache.h"
+#include "ui/ui_app_data.h"
+#include "ui/ui_app_grid.h"
+#include "ui/ui_icon_cache.h"
+#include <glib/gstdio.h>
+#include <raylib.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef struct {
+    gint entries;
+    gint repeats;
+    gint frames;
+    gboolean skip_draw;
+    gchar *generate;
+    gchar *output;
+} BenchOptions;
+
+typedef struct {
+    GArray *samples;
+} BenchSeries;
+
+static const char *const typing_sequences[] = {
+    "firefox", "terminal", "text editor", "sett", "lib calc", "music player", "xyzzy", NULL
+};
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e6 + (double)ts.tv_nsec / 1e3;
+}
+
+static void series_init(BenchSeries *series) {
+    series->samples = g_array_new(FALSE, FALSE, sizeof(double));
+}
+
+static void series_add(BenchSeries *series, double value) {
+    g_array_append_val(series->samples, value);
+}
+
+static gint compare_doubles(gconstpointer a, gconstpointer b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static double series_percentile(const BenchSeries *series, double percentile) {
+    if (series->samples->len == 0)
+        return 0.0;
+    guint index = (guint)(percentile * (series->samples->len - 1) + 0.5);
+    return g_array_index(series->samples, double, index);
+}
+
+static void series_write(GString *json, const char *key, BenchSeries *series, gboolean last) {
+    g_array_sort(series->samples, compare_doubles);
+
+    double total = 0.0;
+    for (guint i = 0; i < series->samples->len; i++)
+        total += g_array_index(series->samples, double, i);
+    double mean = series->samples->len > 0 ? total / series->samples->len : 0.0;
+
+    g_string_append_printf(json,
+                           "    \"%s\": {\"count\": %u, \"mean\": %.2f, \"p50\": %.2f, \"p95\": %.2f, \"max\": %.2f}%s\n",
+                           key, series->samples->len, mean,
+                           series_percentile(series, 0.50),
+                           series_percentile(series, 0.95),
+                           series_percentile(series, 1.0),
+                           last ? "" : ",");
+    g_array_free(series->samples, TRUE);
+    series->samples = NULL;
+}
+
+static glong resident_kb(void) {
+    gchar *statm = NULL;
+    if (!g_file_get_contents("/proc/self/statm", &statm, NULL, NULL))
+        return 0;
+
+    glong pages = 0;
+    sscanf(statm, "%*d %ld", &pages);
+    g_free(statm);
+    return pages * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+static void bench_load(BenchSeries *cold, BenchSeries *warm, gint repeats, guint *app_count) {
+    gchar *cache_path = ui_app_cache_default_path();
+    for (gint i = 0; i < repeats; i++) {
+        UIAppData data;
+        ui_app_data_init(&data);
+        g_unlink(cache_path);
+        double start = now_us();
+        ui_app_data_load(&data);
+        series_add(cold, now_us() - start);
+        ui_app_data_free(&data);
+
+        ui_app_data_init(&data);
+        start = now_us();
+        ui_app_data_load(&data);
+        series_add(warm, now_us() - start);
+        *app_count = ui_app_data_count(&data);
+        ui_app_data_free(&data);
+    }
+    g_free(cache_path);
+}
+
+static void bench_filter(UIAppData *data, BenchSeries *keystrokes, BenchSeries *first_keys, gint repeats) {
+    for (gint r = 0; r < repeats; r++) {
+        for (guint s = 0; typing_sequences[s]; s++) {
+            const char *sequence = typing_sequences[s];
+            gsize len = strlen(sequence);
+            ui_app_data_filter(data, "");
+            for (gsize i = 1; i <= len; i++) {
+                gchar *query = g_strndup(sequence, i);
+                double start = now_us();
+                ui_app_data_filter(data, query);
+                double elapsed = now_us() - start;
+                series_add(keystrokes, elapsed);
+                if (i == 1)
+                    series_add(first_keys, elapsed);
+                g_free(query);
+            }
+        }
+    }
+}
+
+static gboolean bench_draw(UIAppData *data, BenchSeries *full, BenchSeries *scroll, gint frames) {
+    const int width = 1000;
+    const int height = 600;
+    SetTraceLogLevel(LOG_WARNING);
+    SetConfigFlags(FLAG_WINDOW_HIDDEN);
+    InitWindow(width, height, "waycast-bench");
+    if (!IsWindowReady())
+        return FALSE;
+
+    RenderTexture2D target = LoadRenderTexture(width, height);
+    UIIconCache icons;
+    ui_icon_cache_init(&icons);
+    UIAppGrid grid;
+    ui_app_grid_init(&grid);
+
+    Rectangle viewport = {16.0f, 68.0f, (float)(width - 32), (float)(height - 84)};
+    int cols = ui_app_grid_columns((int)viewport.width, 140, 12);
+    ui_app_data_filter(data, "e");
+    ui_app_grid_reset(&grid, ui_app_data_filtered_count(data));
+    float max_scroll = ui_app_grid_content_height(ui_app_data_filtered_count(data), cols, 108, 12) - viewport.height;
+
+    for (gint frame = 0; frame < frames; frame++) {
+        gboolean scrolling = frame % 2 == 1;
+        if (scrolling && max_scroll > 0.0f)
+            grid.scroll_y = (float)((frame * 37) % (int)max_scroll);
+        else
+            grid.selected_index = frame % (int)MAX(1u, MIN(ui_app_data_filtered_count(data), 24u));
+
+        double start = now_us();
+        ui_icon_cache_update(&icons);
+        BeginTextureMode(target);
+        ClearBackground(BLACK);
+        ui_app_grid_draw(&grid, data, &icons, viewport, cols, 140, 108, 12, NULL, 16,
+                         DARKGRAY, GRAY, LIGHTGRAY, WHITE, RAYWHITE);
+        EndTextureMode();
+        series_add(scrolling ? scroll : full, now_us() - start);
+    }
+
+    ui_app_grid_free(&grid);
+    ui_icon_cache_free(&icons);
+    UnloadRenderTexture(target);
+    CloseWindow();
+    return TRUE;
+}
+
+static gboolean parse_options(int *argc, char ***argv, BenchOptions *options) {
+    GOptionEntry entries[] = {
+        {"entries", 'n', 0, G_OPTION_ARG_INT, &options->entries, "Number of synthetic desktop entries", "N"},
+        {"repeats", 'r', 0, G_OPTION_ARG_INT, &options->repeats, "Repetitions of each load and typing run", "N"},
+        {"frames", 'f', 0, G_OPTION_ARG_INT, &options->frames, "Frames to draw for the grid benchmark", "N"},
+        {"no-draw", 0, 0, G_OPTION_ARG_NONE, &options->skip_draw, "Skip the offscreen grid benchmark", NULL},
+        {"generate", 0, 0, G_OPTION_ARG_FILENAME, &options->generate, "Only write a corpus into DIR and exit", "DIR"},
+        {"output", 'o', 0, G_OPTION_ARG_FILENAME, &options->output, "Also write the JSON report to FILE", "FILE"},
+        G_OPTION_ENTRY_NULL
+    };
+
+    GOptionContext *context = g_option_context_new(NULL);
+    g_option_context_add_main_entries(context, entries, NULL);
+
+    GError *error = NULL;
+    gboolean ok = g_option_context_parse(context, argc, argv, &error);
+    if (!ok) {
+        g_printerr("waycast-bench: %s\n", error->message);
+        g_error_free(error);
+    }
+    g_option_context_free(context);
+    return ok;
+}
+
+int main(int argc, char *argv[]) {
+    BenchOptions options = {.entries = 1000, .repeats = 5, .frames = 240};
+    if (!parse_options(&argc, &argv, &options))
+        return EXIT_FAILURE;
+
+    options.entries = CLAMP(options.entries, 1, 1000000);
+    options.repeats = MAX(options.repeats, 1);
+    options.frames = MAX(options.frames, 2);
+
+    BenchCorpus corpus;
+    gchar *root = options.generate ? g_strdup(options.generate) : g_dir_make_tmp("waycast-bench-XXXXXX", NULL);
+    if (!root || !bench_corpus_generate(&corpus, root, (guint)options.entries, 0x5eed)) {
+        g_printerr("waycast-bench: failed to generate corpus\n");
+        g_free(root);
+        return EXIT_FAILURE;
+    }
+    g_free(root);
+
+    if (options.generate) {
+        printf("%s\n", corpus.root);
+        bench_corpus_free(&corpus);
+        g_free(options.generate);
+        g_free(options.output);
+        return EXIT_SUCCESS;
+    }
+
+    bench_corpus_use(&corpus);
+
+    BenchSeries load_cold, load_warm, keystrokes, first_keys, draw_full, draw_scroll;
+    series_init(&load_cold);
+    series_init(&load_warm);
+    series_init(&keystrokes);
+    series_init(&first_keys);
+    series_init(&draw_full);
+    series_init(&draw_scroll);
+
+    guint app_count = 0;
+    bench_load(&load_cold, &load_warm, options.repeats, &app_count);
+
+    glong rss_before = resident_kb();
+    UIAppData data;
+    ui_app_data_init(&data);
+    ui_app_data_load(&data);
+    glong catalog_rss = MAX(resident_kb() - rss_before, 0);
+    bench_filter(&data, &keystrokes, &first_keys, options.repeats);
+
+    gboolean drew = !options.skip_draw && bench_draw(&data, &draw_full, &draw_scroll, options.frames);
+    ui_app_data_free(&data);
+
+    GString *json = g_string_new("{\n");
+    g_string_append_printf(json, "  \"entries\": %d,\n  \"apps\": %u,\n  \"repeats\": %d,\n  \"unit\": \"us\",\n",
+                           options.entries, app_count, options.repeats);
+    g_string_append_printf(json, "  \"catalog_rss_kb\": %ld,\n", catalog_rss);
+    g_string_append(json, "  \"results\": {\n");
+    series_write(json, "load_cold", &load_cold, FALSE);
+    series_write(json, "load_warm", &load_warm, FALSE);
+    series_write(json, "filter_keystroke", &keystrokes, FALSE);
+    series_write(json, "filter_first_key", &first_keys, !drew);
+    if (drew) {
+        series_write(json, "grid_draw_select", &draw_full, FALSE);
+        series_write(json, "grid_draw_scroll", &draw_scroll, TRUE);
+    } else {
+        g_array_free(draw_full.samples, TRUE);
+        g_array_free(draw_scroll.samples, TRUE);
+    }
+    g_string_append(json, "  }\n}\n");
+
+    fputs(json->str, stdout);
+    gboolean ok = TRUE;
+    if (options.output && !g_file_set_contents(options.output, json->str, (gssize)json->len, NULL)) {
+        g_printerr("waycast-bench: could not write %s\n", options.output);
+        ok = FALSE;
+    }
+
+    g_string_free(json, TRUE);
+    bench_corpus_remove(&corpus);
+    bench_corpus_free(&corpus);
+    g_free(options.output);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
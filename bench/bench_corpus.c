@@ -0,0 +1,151 @@
+#include "bench_corpus.h"
+#include <glib/gstdio.h>
+#include <string.h>
+
+#define CORPUS_USER_SHARE 10
+#define CORPUS_SUBDIR_SHARE 5
+
+static const char *const vendors[] = {
+    "GNOME", "KDE", "Mozilla", "LibreOffice", "JetBrains", "Steam", "Flatpak", "Xfce", "Qt", "Electron"
+};
+
+static const char *const words[] = {
+    "Files", "Terminal", "Text", "Editor", "Image", "Viewer", "Music", "Player", "Video", "Settings",
+    "System", "Monitor", "Calculator", "Calendar", "Mail", "Browser", "Office", "Writer", "Calc", "Impress",
+    "Draw", "Paint", "Photo", "Manager", "Disk", "Usage", "Network", "Printer", "Archive", "Backup",
+    "Code", "Studio", "Console", "Shell", "Notes", "Clock", "Weather", "Maps", "Contacts", "Chat",
+    "Firefox", "Thunderbird", "Inkscape", "Krita", "Blender", "Audacity", "Obsidian", "Signal", "Spotify", "Discord"
+};
+
+static const char *const categories[] = {
+    "Utility;", "Development;IDE;", "Graphics;", "AudioVideo;Player;", "Network;WebBrowser;", "Office;", "Settings;", "Game;"
+};
+
+#define COUNT_OF(array) (sizeof(array) / sizeof((array)[0]))
+
+static gchar *corpus_name(GRand *rand, guint index) {
+    GString *name = g_string_new(NULL);
+    if (g_rand_int_range(rand, 0, 4) == 0)
+        g_string_append_printf(name, "%s ", vendors[g_rand_int_range(rand, 0, COUNT_OF(vendors))]);
+
+    gint count = g_rand_int_range(rand, 1, 4);
+    for (gint i = 0; i < count; i++) {
+        if (i > 0)
+            g_string_append_c(name, ' ');
+        g_string_append(name, words[g_rand_int_range(rand, 0, COUNT_OF(words))]);
+    }
+    if (g_rand_int_range(rand, 0, 3) == 0)
+        g_string_append_printf(name, " %u", index);
+    return g_string_free(name, FALSE);
+}
+
+static gboolean write_entry(const char *dir, const char *file_name, const char *name, GRand *rand, guint index) {
+    gchar *exec = g_ascii_strdown(name, -1);
+    g_strdelimit(exec, " ", '-');
+
+    GString *text = g_string_new("[Desktop Entry]\n");
+    g_string_append(text, "Type=Application\n");
+    g_string_append_printf(text, "Name=%s\n", name);
+    g_string_append_printf(text, "GenericName=%s %s\n",
+                           words[g_rand_int_range(rand, 0, COUNT_OF(words))],
+                           words[g_rand_int_range(rand, 0, COUNT_OF(words))]);
+    g_string_append_printf(text, "Comment=Synthetic entry %u for benchmarks\n", index);
+    g_string_append_printf(text, "Exec=%s %%U\n", exec);
+    g_string_append_printf(text, "Icon=%s\n", exec);
+    g_string_append_printf(text, "Categories=%s\n", categories[g_rand_int_range(rand, 0, COUNT_OF(categories))]);
+    if (g_rand_int_range(rand, 0, 50) == 0)
+        g_string_append(text, "NoDisplay=true\n");
+
+    gchar *path = g_build_filename(dir, file_name, NULL);
+    gboolean ok = g_file_set_contents(path, text->str, (gssize)text->len, NULL);
+    g_free(path);
+    g_string_free(text, TRUE);
+    g_free(exec);
+    return ok;
+}
+
+gboolean bench_corpus_generate(BenchCorpus *corpus, const char *root, guint entries, guint32 seed) {
+    if (!corpus || !root)
+        return FALSE;
+
+    memset(corpus, 0, sizeof(*corpus));
+    corpus->root = g_strdup(root);
+    corpus->user_data_dir = g_build_filename(root, "user", NULL);
+    corpus->system_data_dir = g_build_filename(root, "system", NULL);
+    corpus->cache_dir = g_build_filename(root, "cache", NULL);
+    corpus->entries = entries;
+
+    gchar *user_apps = g_build_filename(corpus->user_data_dir, "applications", NULL);
+    gchar *system_apps = g_build_filename(corpus->system_data_dir, "applications", NULL);
+    gchar *vendor_apps = g_build_filename(system_apps, "vendor", NULL);
+    gboolean ok = g_mkdir_with_parents(user_apps, 0755) == 0 &&
+                  g_mkdir_with_parents(vendor_apps, 0755) == 0 &&
+                  g_mkdir_with_parents(corpus->cache_dir, 0700) == 0;
+
+    GRand *rand = g_rand_new_with_seed(seed);
+    for (guint i = 0; ok && i < entries; i++) {
+        gchar *name = corpus_name(rand, i);
+        gchar *file_name = g_strdup_printf("org.bench.App%u.desktop", i);
+        guint bucket = (guint)g_rand_int_range(rand, 0, 100);
+
+        const char *dir = system_apps;
+        if (bucket < CORPUS_USER_SHARE)
+            dir = user_apps;
+        else if (bucket < CORPUS_USER_SHARE + CORPUS_SUBDIR_SHARE)
+            dir = vendor_apps;
+        ok = write_entry(dir, file_name, name, rand, i);
+
+        if (ok && bucket < CORPUS_USER_SHARE / 2)
+            ok = write_entry(system_apps, file_name, name, rand, i);
+
+        g_free(file_name);
+        g_free(name);
+    }
+    g_rand_free(rand);
+
+    g_free(vendor_apps);
+    g_free(system_apps);
+    g_free(user_apps);
+    return ok;
+}
+
+void bench_corpus_use(const BenchCorpus *corpus) {
+    if (!corpus)
+        return;
+
+    g_setenv("XDG_DATA_HOME", corpus->user_data_dir, TRUE);
+    g_setenv("XDG_DATA_DIRS", corpus->system_data_dir, TRUE);
+    g_setenv("XDG_CACHE_HOME", corpus->cache_dir, TRUE);
+}
+
+static void remove_tree(const char *path) {
+    GDir *dir = g_dir_open(path, 0, NULL);
+    if (dir) {
+        const gchar *name;
+        while ((name = g_dir_read_name(dir)) != NULL) {
+            gchar *child = g_build_filename(path, name, NULL);
+            remove_tree(child);
+            g_free(child);
+        }
+        g_dir_close(dir);
+        g_rmdir(path);
+    } else {
+        g_unlink(path);
+    }
+}
+
+void bench_corpus_remove(const BenchCorpus *corpus) {
+    if (corpus && corpus->root)
+        remove_tree(corpus->root);
+}
+
+void bench_corpus_free(BenchCorpus *corpus) {
+    if (!corpus)
+        return;
+
+    g_free(corpus->root);
+    g_free(corpus->user_data_dir);
+    g_free(corpus->system_data_dir);
+    g_free(corpus->cache_dir);
+    memset(corpus, 0, sizeof(*corpus));
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include <glib.h>
+
+typedef struct {
+    char *root;
+    char *user_data_dir;
+    char *system_data_dir;
+    char *cache_dir;
+    guint entries;
+} BenchCorpus;
+
+gboolean bench_corpus_generate(BenchCorpus *corpus, const char *root, guint entries, guint32 seed);
+void bench_corpus_use(const BenchCorpus *corpus);
+void bench_corpus_remove(const BenchCorpus *corpus);
+void bench_corpus_free(BenchCorpus *corpus);
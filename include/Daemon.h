@@ -0,0 +1,44 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define DAEMON_MAX_PENDING 4
+#define DAEMON_LINE_MAX 64
+
+typedef enum {
+    DAEMON_COMMAND_NONE,
+    DAEMON_COMMAND_SHOW,
+    DAEMON_COMMAND_HIDE,
+    DAEMON_COMMAND_TOGGLE,
+    DAEMON_COMMAND_STATUS,
+    DAEMON_COMMAND_QUIT
+} DaemonCommand;
+
+typedef struct {
+    int fd;
+    int64_t deadline;
+    size_t length;
+    char line[DAEMON_LINE_MAX];
+} DaemonClient;
+
+typedef struct {
+    int lock_fd;
+    int listen_fd;
+    int client_fd;
+    char *socket_path;
+    DaemonClient pending[DAEMON_MAX_PENDING];
+} DaemonServer;
+
+const char *daemon_command_name(DaemonCommand command);
+DaemonCommand daemon_command_parse(const char *name);
+
+void daemon_server_init(DaemonServer *server);
+bool daemon_server_open(DaemonServer *server);
+void daemon_server_close(DaemonServer *server);
+int daemon_server_fd(const DaemonServer *server);
+size_t daemon_server_fds(const DaemonServer *server, int *fds, size_t max);
+DaemonCommand daemon_server_accept(DaemonServer *server);
+void daemon_server_reply(DaemonServer *server, const char *reply);
+
+bool daemon_client_send(DaemonCommand command, char *reply, size_t reply_size);
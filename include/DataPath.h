@@ -0,0 +1,3 @@
+#pragma once
+
+char *data_path_find(const char *relative);
@@ -1,3 +1,41 @@
 #pragma once
+#include <glib.h>
+#include <raylib.h>
+#include <stdbool.h>
 
-void theme_manager_apply(const char *theme_name);
+typedef struct {
+    Color background;
+    Color panel;
+    Color panel_border;
+    Color text;
+    Color muted_text;
+    Color label;
+    Color highlight;
+    Color highlight_border;
+    Color window_border;
+} Palette;
+
+typedef struct {
+    gint32 margin;
+    gint32 search_height;
+    gint32 search_padding;
+    gint32 search_font_size;
+    gint32 cell_width;
+    gint32 cell_height;
+    gint32 cell_gap;
+    gint32 label_font_size;
+} ThemeMetrics;
+
+typedef struct {
+    char *name;
+    char *path;
+    gint64 mtime;
+    gint64 size;
+    Palette palette;
+    ThemeMetrics metrics;
+} Theme;
+
+void theme_init(Theme *theme);
+void theme_free(Theme *theme);
+bool theme_manager_load(Theme *theme, const char *theme_name);
+bool theme_manager_reload(Theme *theme);
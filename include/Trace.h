@@ -0,0 +1,39 @@
+#pragma once
+#include <glib.h>
+#include <stdbool.h>
+
+#define TRACE_ENV "WAYCAST_TRACE"
+#define TRACE_OVERLAY_ENV "WAYCAST_TRACE_OVERLAY"
+
+typedef struct {
+    const char *name;
+    gint64 start;
+} TraceSpan;
+
+extern bool trace_active;
+
+bool trace_init(const char *path, bool overlay);
+void trace_shutdown(void);
+bool trace_overlay_enabled(void);
+gint64 trace_now(void);
+void trace_record(const char *name, gint64 start, gint64 end);
+void trace_instant(const char *name);
+
+static inline TraceSpan trace_span_begin(const char *name) {
+    TraceSpan span = {NULL, 0};
+    if (G_UNLIKELY(trace_active)) {
+        span.name = name;
+        span.start = trace_now();
+    }
+    return span;
+}
+
+static inline void trace_span_end(TraceSpan *span) {
+    if (G_UNLIKELY(span->name != NULL)) {
+        trace_record(span->name, span->start, trace_now());
+        span->name = NULL;
+    }
+}
+
+#define TRACE_SCOPE(name) \
+    TraceSpan G_PASTE(trace_scope_, __LINE__) __attribute__((cleanup(trace_span_end))) = trace_span_begin(name)
@@ -1,4 +1,6 @@
 #pragma once
 #include "ConfigLoader.h"
+#include "Daemon.h"
+#include <stdbool.h>
 
-void ui_manager_start(const Config *config);
+bool ui_manager_start(const Config *config, DaemonServer *server, bool resident, int dmenu_input);
@@ -0,0 +1,61 @@
+#pragma once
+#include <glib.h>
+
+#define UI_APP_CACHE_ENTRY_VISIBLE (1u << 0)
+#define UI_APP_CACHE_ENTRY_PARSED (1u << 1)
+#define UI_APP_CACHE_ENTRY_TERMINAL (1u << 2)
+
+typedef struct {
+    gint64 mtime;
+    gint64 size;
+    guint32 flags;
+    const char *file;
+    const char *name;
+    const char *exec;
+    const char *icon;
+    const char *generic_name;
+    const char *keywords;
+    const char *comment;
+    const char *working_dir;
+    const char *try_exec;
+} UIAppCacheEntry;
+
+typedef struct {
+    GMappedFile *mapped;
+    const guint8 *base;
+    guint32 dir_count;
+    guint32 entry_count;
+    guint32 trigram_count;
+    guint32 posting_count;
+    guint32 strings_size;
+} UIAppCache;
+
+typedef struct {
+    GArray *dirs;
+    GArray *entries;
+    GString *strings;
+    GHashTable *interned;
+    GHashTable *postings;
+    GArray *trigrams;
+} UIAppCacheWriter;
+
+char *ui_app_cache_default_path(void);
+
+void ui_app_cache_init(UIAppCache *cache);
+gboolean ui_app_cache_open(UIAppCache *cache, const char *path);
+void ui_app_cache_close(UIAppCache *cache);
+guint ui_app_cache_dir_count(const UIAppCache *cache);
+gint ui_app_cache_find_dir(const UIAppCache *cache, const char *dir_path, gint64 *mtime);
+gint ui_app_cache_dir_parent(const UIAppCache *cache, gint dir);
+const char *ui_app_cache_dir_path(const UIAppCache *cache, gint dir);
+guint ui_app_cache_dir_entry_count(const UIAppCache *cache, gint dir);
+gboolean ui_app_cache_dir_entry(const UIAppCache *cache, gint dir, guint pos, UIAppCacheEntry *entry);
+guint ui_app_cache_entry_count(const UIAppCache *cache);
+const guint32 *ui_app_cache_postings(const UIAppCache *cache, guint32 trigram, guint *count);
+gboolean ui_app_cache_lookup(const UIAppCache *cache, gint dir, const char *file, UIAppCacheEntry *entry);
+
+void ui_app_cache_writer_init(UIAppCacheWriter *writer);
+void ui_app_cache_writer_clear(UIAppCacheWriter *writer);
+gint ui_app_cache_writer_add_dir(UIAppCacheWriter *writer, const char *dir_path, gint parent, gint64 mtime);
+void ui_app_cache_writer_add_entry(UIAppCacheWriter *writer, const UIAppCacheEntry *entry);
+gboolean ui_app_cache_writer_commit(UIAppCacheWriter *writer, const char *path);
@@ -1,24 +1,135 @@
 #pragma once
+#include "ui/ui_app_cache.h"
+#include "ui/ui_file_db.h"
+#include "ui/ui_line_store.h"
+#include "ui/ui_path_index.h"
 #include <glib.h>
 
+#define UI_APP_DATA_MAX_RESULTS 256
+#define UI_APP_RESULT_EXTERNAL (1u << 31)
+
+typedef struct {
+    char *path;
+    char *id_prefix;
+} UIAppDir;
+
 typedef struct {
-    char *name;
-    char *exec;
-    char *icon;
+    const char *id;
+    const char *name;
+    const char *exec;
+    const char *icon;
+    const char *path;
+    const char *working_dir;
+    gboolean terminal;
 } App;
 
 typedef struct {
-    GPtrArray *apps;
+    gint score;
+    guint index;
+} UIAppMatch;
+
+typedef struct {
+    gint score;
+    guint index;
+    App app;
+} UIAppResult;
+
+typedef enum {
+    UI_APP_FIELD_GENERIC_NAME,
+    UI_APP_FIELD_KEYWORDS,
+    UI_APP_FIELD_COMMENT,
+    UI_APP_FIELD_COUNT
+} UIAppField;
+
+typedef struct {
+    guint32 offsets[UI_APP_FIELD_COUNT];
+} UIAppFieldKeys;
+
+typedef struct {
+    GArray *matches;
+    GArray *trigrams;
+    GArray *candidates;
+    char *last_query;
+    guint revision;
+} UIAppSearch;
+
+typedef gboolean (*UIAppSearchCancelled)(gpointer user_data);
+
+typedef struct UIAppLoad UIAppLoad;
+
+typedef struct {
+    GStringChunk *strings;
+    GArray *apps;
+    GPtrArray *dirs;
+    GString *search_keys;
+    gsize dead_keys;
+    GArray *search_offsets;
+    GArray *search_masks;
+    GArray *field_keys;
+    GArray *frecency;
+    GArray *app_entries;
+    GArray *entry_apps;
+    UIAppCache index;
+    guint unindexed;
     GArray *filtered_indices;
+    GStringChunk *result_strings;
+    GArray *result_apps;
+    UIFileDb files;
+    UIPathIndex commands;
+    UILineStore lines;
+    UIAppSearch search;
+    guint revision;
+    guint files_revision;
+    guint commands_revision;
+    guint generation;
 } UIAppData;
 
 void ui_app_data_init(UIAppData *data);
 void ui_app_data_free(UIAppData *data);
 void ui_app_data_load(UIAppData *data);
+UIAppLoad *ui_app_load_new(int watch_fd);
+gboolean ui_app_load_next(UIAppLoad *load, UIAppData *data, guint max_apps);
+void ui_app_load_free(UIAppLoad *load);
+GPtrArray *ui_app_data_directories(void);
+gboolean ui_app_data_add_dir(UIAppData *data, const char *path);
+gboolean ui_app_data_refresh_file(UIAppData *data, const char *path);
 void ui_app_data_filter(UIAppData *data, const char *query);
+void ui_app_data_set_results(UIAppData *data, const UIAppResult *results, guint count);
+gboolean ui_app_data_load_files(UIAppData *data);
+gboolean ui_app_data_is_file_query(const char *query);
+void ui_app_data_set_commands(UIAppData *data, UIPathIndex *commands);
+gboolean ui_app_data_is_command_query(const char *query);
+
+void ui_app_search_init(UIAppSearch *search);
+void ui_app_search_clear(UIAppSearch *search);
+gboolean ui_app_data_search(const UIAppData *data,
+                            UIAppSearch *search,
+                            const char *query,
+                            GArray *results,
+                            UIAppSearchCancelled cancelled,
+                            gpointer user_data);
+gboolean ui_app_data_search_lines(const UIAppData *data,
+                                  const char *query,
+                                  GArray *results,
+                                  UIAppSearchCancelled cancelled,
+                                  gpointer user_data);
+gboolean ui_app_data_search_commands(const UIAppData *data,
+                                     const char *query,
+                                     GArray *results,
+                                     UIAppSearchCancelled cancelled,
+                                     gpointer user_data);
+gboolean ui_app_data_search_files(const UIAppData *data,
+                                  const char *query,
+                                  GArray *results,
+                                  UIAppSearchCancelled cancelled,
+                                  gpointer user_data);
 
+guint ui_app_data_count(const UIAppData *data);
 guint ui_app_data_filtered_count(const UIAppData *data);
 guint ui_app_data_filtered_index(const UIAppData *data, guint filtered_pos);
+const App *ui_app_data_filtered_app(const UIAppData *data, guint filtered_pos);
 const App *ui_app_data_get(const UIAppData *data, guint index);
+guint ui_app_data_frecency(const UIAppData *data, guint index);
+void ui_app_data_set_frecency(UIAppData *data, guint index, guint frecency);
 
-void ui_app_launch(const App *app);
+gboolean ui_app_launch(const App *app);
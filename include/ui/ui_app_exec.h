@@ -0,0 +1,9 @@
+#pragma once
+#include "ui/ui_path_index.h"
+#include <glib.h>
+
+#define UI_APP_EXEC_SEPARATOR "\x1f"
+
+gchar *ui_app_exec_compile(const char *exec, const char *name, const char *icon, const char *desktop_path);
+gboolean ui_app_exec_available(const UIPathIndex *commands, const char *try_exec);
+gboolean ui_app_exec_spawn(const char *compiled, const char *working_dir, gboolean terminal);
@@ -1,28 +1,62 @@
 #pragma once
 #include "ui/ui_app_data.h"
+#include "ui/ui_glyph_atlas.h"
+#include "ui/ui_icon_cache.h"
 #include <raylib.h>
 
+typedef struct {
+    int *codepoints;
+    int count;
+} UIAppGridLabel;
+
+typedef struct {
+    Rectangle viewport;
+    float scroll_y;
+    int cols;
+    int cell_width;
+    int cell_height;
+    int cell_gap;
+    unsigned int font_id;
+    int font_size;
+    guint font_generation;
+    guint generation;
+    Color colors[3];
+} UIAppGridLayerKey;
+
 typedef struct {
     int selected_index;
     float scroll_y;
+    RenderTexture2D layer;
+    UIAppGridLayerKey layer_key;
+    bool layer_valid;
+    GArray *pending_cells;
+    guint64 pending_serial;
+    GHashTable *labels;
+    unsigned int label_font_id;
+    int label_font_size;
+    int label_width;
 } UIAppGrid;
 
 void ui_app_grid_init(UIAppGrid *grid);
+void ui_app_grid_free(UIAppGrid *grid);
 void ui_app_grid_reset(UIAppGrid *grid, guint filtered_count);
+void ui_app_grid_clamp(UIAppGrid *grid, guint filtered_count);
 int ui_app_grid_columns(int available_width, int cell_width, int cell_gap);
 float ui_app_grid_content_height(guint filtered_count, int cols, int cell_height, int cell_gap);
 void ui_app_grid_handle_navigation(UIAppGrid *grid, int cols, guint filtered_count);
 void ui_app_grid_handle_scroll(UIAppGrid *grid, float max_scroll);
+void ui_app_grid_handle_mouse(UIAppGrid *grid, Rectangle viewport, int cols, int cell_width, int cell_height, int cell_gap, guint filtered_count);
 void ui_app_grid_ensure_visible(UIAppGrid *grid, int cols, float viewport_height, int cell_height, int cell_gap);
 void ui_app_grid_draw(UIAppGrid *grid,
                       const UIAppData *data,
+                      UIIconCache *icons,
                       Rectangle viewport,
                       int cols,
                       int cell_width,
                       int cell_height,
                       int cell_gap,
-                      Font font,
-                      bool has_font,
+                      UIGlyphAtlas *glyphs,
+                      int font_size,
                       Color panel_color,
                       Color panel_border,
                       Color highlight_color,
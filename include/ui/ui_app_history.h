@@ -0,0 +1,15 @@
+#pragma once
+#include "ui/ui_app_data.h"
+#include <glib.h>
+
+typedef struct {
+    char *path;
+    GHashTable *stats;
+    guint record_count;
+} UIAppHistory;
+
+void ui_app_history_init(UIAppHistory *history);
+void ui_app_history_free(UIAppHistory *history);
+void ui_app_history_load(UIAppHistory *history);
+void ui_app_history_apply(const UIAppHistory *history, UIAppData *data);
+void ui_app_history_record(UIAppHistory *history, const App *app);
@@ -0,0 +1,22 @@
+#pragma once
+#include "ui/ui_app_data.h"
+#include <glib.h>
+#include <stdbool.h>
+
+#define UI_APP_LOADER_BATCH 256
+
+typedef struct {
+    GThread *thread;
+    UIAppLoad *load;
+    int fd;
+    int watch_fd;
+    bool finished;
+} UIAppLoader;
+
+void ui_app_loader_init(UIAppLoader *loader);
+void ui_app_loader_start(UIAppLoader *loader, int watch_fd);
+void ui_app_loader_free(UIAppLoader *loader);
+int ui_app_loader_fd(const UIAppLoader *loader);
+bool ui_app_loader_ready(const UIAppLoader *loader);
+bool ui_app_loader_finished(const UIAppLoader *loader);
+bool ui_app_loader_poll(UIAppLoader *loader, UIAppData *data);
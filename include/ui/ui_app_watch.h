@@ -0,0 +1,19 @@
+#pragma once
+#include "ui/ui_app_data.h"
+#include <glib.h>
+
+typedef struct {
+    int fd;
+    GHashTable *dirs;
+    GHashTable *parents;
+    GPtrArray *missing;
+} UIAppWatch;
+
+void ui_app_watch_init(UIAppWatch *watch);
+gboolean ui_app_watch_open(UIAppWatch *watch);
+int ui_app_watch_add_dir(int fd, const char *path);
+gboolean ui_app_watch_start(UIAppWatch *watch, UIAppData *data);
+void ui_app_watch_stop(UIAppWatch *watch);
+int ui_app_watch_fd(const UIAppWatch *watch);
+gboolean ui_app_watch_ready(const UIAppWatch *watch);
+gboolean ui_app_watch_poll(UIAppWatch *watch, UIAppData *data);
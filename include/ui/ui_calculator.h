@@ -0,0 +1,7 @@
+#pragma once
+#include "ui/ui_provider.h"
+#include <glib.h>
+
+gboolean ui_calculator_eval(const char *expression, double *value);
+
+extern const UIProvider ui_provider_calculator;
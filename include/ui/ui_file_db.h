@@ -0,0 +1,38 @@
+#pragma once
+#include <glib.h>
+
+#define UI_FILE_DB_ENTRY_DIR (1u << 0)
+
+typedef struct {
+    GMappedFile *mapped;
+    const guint8 *base;
+    guint32 entry_count;
+    guint32 block_count;
+    gsize data_size;
+} UIFileDb;
+
+typedef struct {
+    char *path;
+    gint64 mtime;
+    guint32 flags;
+} UIFileDbEntry;
+
+typedef void (*UIFileDbVisit)(const char *path, gint64 mtime, guint32 flags, gpointer user_data);
+typedef void (*UIFileDbMatch)(guint32 entry, gint score, gpointer user_data);
+typedef gboolean (*UIFileDbCancelled)(gpointer user_data);
+
+char *ui_file_db_default_path(void);
+
+void ui_file_db_init(UIFileDb *db);
+gboolean ui_file_db_open(UIFileDb *db, const char *path);
+void ui_file_db_close(UIFileDb *db);
+guint ui_file_db_count(const UIFileDb *db);
+gboolean ui_file_db_entry(const UIFileDb *db, guint32 index, GString *path, guint32 *flags);
+void ui_file_db_foreach(const UIFileDb *db, UIFileDbVisit visit, gpointer user_data);
+gboolean ui_file_db_search(const UIFileDb *db,
+                           const char *folded_query,
+                           UIFileDbMatch match,
+                           UIFileDbCancelled cancelled,
+                           gpointer user_data);
+
+gboolean ui_file_db_write(const char *path, GArray *entries);
@@ -0,0 +1,31 @@
+#pragma once
+#include "ui/ui_path_index.h"
+#include <glib.h>
+#include <stdbool.h>
+
+typedef struct {
+    GThread *thread;
+    GMutex mutex;
+    GCond cond;
+    char *root;
+    char *db_path;
+    int fd;
+    gboolean requested;
+    gboolean commands_requested;
+    gboolean running;
+    gint quit;
+    gint ready;
+    gint commands_ready;
+    gint64 last_scan;
+    UIPathIndex commands;
+} UIFileIndexer;
+
+void ui_file_indexer_init(UIFileIndexer *indexer);
+void ui_file_indexer_free(UIFileIndexer *indexer);
+void ui_file_indexer_request(UIFileIndexer *indexer);
+bool ui_file_indexer_ready(const UIFileIndexer *indexer);
+bool ui_file_indexer_take(UIFileIndexer *indexer);
+int ui_file_indexer_fd(const UIFileIndexer *indexer);
+void ui_file_indexer_request_commands(UIFileIndexer *indexer);
+bool ui_file_indexer_commands_ready(const UIFileIndexer *indexer);
+bool ui_file_indexer_take_commands(UIFileIndexer *indexer, UIPathIndex *commands);
@@ -0,0 +1,11 @@
+#pragma once
+#include <glib.h>
+
+#define UI_FUZZY_NO_MATCH (-1)
+
+guint64 ui_fuzzy_char_mask(const char *folded);
+guint ui_fuzzy_prefilter(const guint64 *masks, guint count, guint64 query_mask, guint *candidates);
+gint ui_fuzzy_score(const char *folded_text, const char *folded_query);
+gint ui_fuzzy_substring_score(const char *folded_text, const char *folded_query);
+void ui_fuzzy_trigrams(const char *folded, GArray *trigrams);
+void ui_fuzzy_sort_unique(GArray *values);
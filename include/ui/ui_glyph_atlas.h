@@ -0,0 +1,41 @@
+#pragma once
+#include <glib.h>
+#include <raylib.h>
+#include <stdbool.h>
+
+typedef struct {
+    char *path;
+    unsigned char *data;
+    int data_size;
+    bool loaded;
+} UIGlyphSource;
+
+typedef struct {
+    int size;
+    Font font;
+    GArray *glyph_info;
+    GArray *glyph_recs;
+    GHashTable *glyphs;
+    guint8 *alpha;
+    int pen_x;
+    int pen_y;
+    int row_height;
+    guint resets;
+    bool dirty;
+} UIGlyphFace;
+
+typedef struct {
+    GArray *sources;
+    GPtrArray *faces;
+    guint64 key;
+    bool ready;
+} UIGlyphAtlas;
+
+void ui_glyph_atlas_init(UIGlyphAtlas *atlas);
+bool ui_glyph_atlas_open(UIGlyphAtlas *atlas, const char *relative_path);
+void ui_glyph_atlas_save(UIGlyphAtlas *atlas);
+void ui_glyph_atlas_free(UIGlyphAtlas *atlas);
+bool ui_glyph_atlas_ready(const UIGlyphAtlas *atlas);
+Font ui_glyph_atlas_font(UIGlyphAtlas *atlas, int size, const int *codepoints, int count);
+Font ui_glyph_atlas_text_font(UIGlyphAtlas *atlas, int size, const char *text);
+guint ui_glyph_atlas_generation(UIGlyphAtlas *atlas, int size);
@@ -0,0 +1,43 @@
+#pragma once
+#include "ui/ui_icon_theme.h"
+#include <glib.h>
+#include <raylib.h>
+#include <stdbool.h>
+
+#define UI_ICON_CACHE_ICON_SIZE 48
+#define UI_ICON_CACHE_ATLAS_SIZE 1024
+#define UI_ICON_CACHE_MAX_ATLASES 2
+#define UI_ICON_CACHE_UPLOADS_PER_FRAME 8
+
+typedef struct UIIconEntry UIIconEntry;
+
+typedef struct {
+    UIIconEntry *owner;
+    guint64 last_used;
+} UIIconSlot;
+
+typedef struct {
+    GThreadPool *pool;
+    GAsyncQueue *results;
+    GHashTable *entries;
+    UIIconSlot *slots;
+    guint slot_count;
+    guint slots_per_atlas;
+    Texture2D atlases[UI_ICON_CACHE_MAX_ATLASES];
+    int atlas_count;
+    guint64 frame;
+    guint64 request_serial;
+    guint loading;
+    guint64 upload_serial;
+    gint shutting_down;
+    GMutex theme_lock;
+    UIIconTheme theme;
+    gboolean theme_stale;
+} UIIconCache;
+
+void ui_icon_cache_init(UIIconCache *cache);
+void ui_icon_cache_free(UIIconCache *cache);
+bool ui_icon_cache_update(UIIconCache *cache);
+bool ui_icon_cache_pending(const UIIconCache *cache);
+void ui_icon_cache_refresh(UIIconCache *cache);
+bool ui_icon_cache_draw(UIIconCache *cache, const char *icon, Rectangle dest, Color tint);
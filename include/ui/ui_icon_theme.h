@@ -0,0 +1,14 @@
+#pragma once
+#include <glib.h>
+
+typedef struct {
+    char *name;
+    GPtrArray *chain;
+} UIIconTheme;
+
+char *ui_icon_theme_default_name(void);
+
+void ui_icon_theme_init(UIIconTheme *theme);
+gboolean ui_icon_theme_load(UIIconTheme *theme, const char *name);
+void ui_icon_theme_free(UIIconTheme *theme);
+gchar *ui_icon_theme_lookup(const UIIconTheme *theme, const char *icon, gint size);
@@ -0,0 +1,22 @@
+#pragma once
+#include "ui/ui_line_store.h"
+#include <glib.h>
+#include <stdbool.h>
+
+typedef struct {
+    GThread *thread;
+    UILineStore *store;
+    int input;
+    int fd;
+    int quit_fd;
+    guint seen;
+    gint done;
+    bool finished;
+} UILineReader;
+
+void ui_line_reader_init(UILineReader *reader);
+void ui_line_reader_start(UILineReader *reader, UILineStore *store, int input);
+void ui_line_reader_free(UILineReader *reader);
+int ui_line_reader_fd(const UILineReader *reader);
+bool ui_line_reader_finished(const UILineReader *reader);
+bool ui_line_reader_poll(UILineReader *reader);
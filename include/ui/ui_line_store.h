@@ -0,0 +1,36 @@
+#pragma once
+#include <glib.h>
+
+#define UI_LINE_STORE_BLOCK 4096
+#define UI_LINE_STORE_MAX_BLOCKS (1u << 16)
+
+typedef struct {
+    const char *text[UI_LINE_STORE_BLOCK];
+    guint64 masks[UI_LINE_STORE_BLOCK];
+} UILineBlock;
+
+typedef struct {
+    UILineBlock **blocks;
+    GPtrArray *chunks;
+    char *chunk;
+    gsize chunk_used;
+    gsize chunk_size;
+    guint count;
+    gint published;
+} UILineStore;
+
+typedef void (*UILineStoreMatch)(guint index, gint score, gpointer user_data);
+typedef gboolean (*UILineStoreCancelled)(gpointer user_data);
+
+void ui_line_store_init(UILineStore *store);
+void ui_line_store_clear(UILineStore *store);
+gboolean ui_line_store_append(UILineStore *store, const char *text, gsize length);
+void ui_line_store_publish(UILineStore *store);
+guint ui_line_store_count(const UILineStore *store);
+const char *ui_line_store_get(const UILineStore *store, guint index);
+gboolean ui_line_store_search(const UILineStore *store,
+                              guint count,
+                              const char *folded_query,
+                              UILineStoreMatch match,
+                              UILineStoreCancelled cancelled,
+                              gpointer user_data);
@@ -0,0 +1,26 @@
+#pragma once
+#include <glib.h>
+
+typedef struct {
+    GMappedFile *mapped;
+    GByteArray *blob;
+    const guint8 *base;
+    guint32 dir_count;
+    guint32 name_count;
+    guint32 bucket_count;
+    guint32 strings_size;
+} UIPathIndex;
+
+char *ui_path_index_default_path(void);
+
+void ui_path_index_init(UIPathIndex *index);
+gboolean ui_path_index_load(UIPathIndex *index);
+gboolean ui_path_index_valid(const UIPathIndex *index);
+void ui_path_index_close(UIPathIndex *index);
+gboolean ui_path_index_ready(const UIPathIndex *index);
+guint ui_path_index_count(const UIPathIndex *index);
+const char *ui_path_index_name(const UIPathIndex *index, guint position);
+const char *ui_path_index_dir(const UIPathIndex *index, guint position);
+gint ui_path_index_find(const UIPathIndex *index, const char *name);
+gboolean ui_path_index_contains(const UIPathIndex *index, const char *name);
+guint ui_path_index_prefix_range(const UIPathIndex *index, const char *prefix, guint *first);
@@ -0,0 +1,47 @@
+#pragma once
+#include "ui/ui_app_data.h"
+#include <glib.h>
+
+typedef enum {
+    UI_PROVIDER_APPS,
+    UI_PROVIDER_FILES,
+    UI_PROVIDER_CALCULATOR,
+    UI_PROVIDER_COMMANDS,
+    UI_PROVIDER_LINES,
+    UI_PROVIDER_COUNT
+} UIProviderKind;
+
+#define UI_PROVIDER_MASK(kind) (1u << (kind))
+#define UI_PROVIDER_LAUNCHER \
+    (UI_PROVIDER_MASK(UI_PROVIDER_APPS) | UI_PROVIDER_MASK(UI_PROVIDER_FILES) | \
+     UI_PROVIDER_MASK(UI_PROVIDER_CALCULATOR) | UI_PROVIDER_MASK(UI_PROVIDER_COMMANDS))
+
+typedef struct {
+    GArray *items;
+    GStringChunk *strings;
+} UIProviderResults;
+
+typedef struct {
+    const char *name;
+    gint64 budget_us;
+    gint64 timeout_us;
+    gboolean catalog;
+    guint (*revision)(const UIAppData *data);
+    gboolean (*accepts)(const char *query);
+    gpointer (*state_new)(void);
+    void (*state_free)(gpointer state);
+    gboolean (*search)(const UIAppData *data,
+                       gpointer state,
+                       const char *query,
+                       UIProviderResults *results,
+                       UIAppSearchCancelled cancelled,
+                       gpointer user_data);
+} UIProvider;
+
+const UIProvider *ui_provider_get(UIProviderKind kind);
+
+void ui_provider_results_init(UIProviderResults *results);
+void ui_provider_results_clear(UIProviderResults *results);
+void ui_provider_results_reset(UIProviderResults *results);
+void ui_provider_results_add_catalog(UIProviderResults *results, gint score, guint index);
+void ui_provider_results_add(UIProviderResults *results, gint score, const App *app);
@@ -1,4 +1,5 @@
 #pragma once
+#include "ui/ui_glyph_atlas.h"
 #include <raylib.h>
 #include <stdbool.h>
 
@@ -15,8 +16,9 @@ bool ui_search_bar_handle_input(UISearchBar *bar, bool *should_close);
 
 void ui_search_bar_draw(const UISearchBar *bar,
                         Rectangle rect,
-                        Font font,
-                        bool has_font,
+                        UIGlyphAtlas *glyphs,
+                        int font_size,
+                        int text_padding,
                         Color text_color,
                         Color muted_color,
                         Color panel_color,
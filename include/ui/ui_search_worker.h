@@ -0,0 +1,55 @@
+#pragma once
+#include "ui/ui_app_data.h"
+#include "ui/ui_provider.h"
+#include <glib.h>
+#include <stdbool.h>
+
+#define UI_SEARCH_WORKER_SLOTS 3
+
+typedef struct UISearchWorker UISearchWorker;
+
+typedef struct {
+    gint serial;
+    guint revision;
+    UIProviderResults results;
+} UISearchResult;
+
+typedef struct {
+    UISearchWorker *worker;
+    const UIProvider *provider;
+    gpointer state;
+    GThread *thread;
+    char *query;
+    gint query_serial;
+    gint active_serial;
+    gint accepted_serial;
+    gint64 deadline;
+    gint ready;
+    guint back;
+    guint front;
+    UISearchResult slots[UI_SEARCH_WORKER_SLOTS];
+} UISearchLane;
+
+struct UISearchWorker {
+    GMutex mutex;
+    GCond cond;
+    GRWLock catalog_lock;
+    const UIAppData *data;
+    gboolean quit;
+    gint latest_serial;
+    gint writer_waiting;
+    gint64 submitted_at;
+    gint merged_serial;
+    guint merged_lanes;
+    guint lane_count;
+    GArray *merged;
+    UISearchLane lanes[UI_PROVIDER_COUNT];
+};
+
+void ui_search_worker_init(UISearchWorker *worker, const UIAppData *data, guint providers);
+void ui_search_worker_free(UISearchWorker *worker);
+void ui_search_worker_submit(UISearchWorker *worker, const char *query);
+bool ui_search_worker_poll(UISearchWorker *worker, UIAppData *data);
+bool ui_search_worker_pending(const UISearchWorker *worker);
+bool ui_search_worker_lock_catalog(UISearchWorker *worker, bool wait);
+void ui_search_worker_unlock_catalog(UISearchWorker *worker);
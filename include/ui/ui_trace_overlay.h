@@ -0,0 +1,25 @@
+#pragma once
+#include "ui/ui_glyph_atlas.h"
+#include <glib.h>
+#include <raylib.h>
+#include <stdbool.h>
+
+#define UI_TRACE_OVERLAY_SAMPLES 120
+
+typedef struct {
+    float frame_ms[UI_TRACE_OVERLAY_SAMPLES];
+    guint frame_pos;
+    guint frame_count;
+    gint64 input_at;
+    float latency_ms;
+    float latency_max_ms;
+} UITraceOverlay;
+
+void ui_trace_overlay_init(UITraceOverlay *overlay);
+void ui_trace_overlay_input(UITraceOverlay *overlay, gint64 at);
+void ui_trace_overlay_frame(UITraceOverlay *overlay, gint64 start, gint64 end);
+void ui_trace_overlay_draw(const UITraceOverlay *overlay,
+                           Rectangle bounds,
+                           UIGlyphAtlas *glyphs,
+                           Color text_color,
+                           Color panel_color);
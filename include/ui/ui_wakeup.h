@@ -0,0 +1,21 @@
+#pragma once
+#include <glib.h>
+#include <stdbool.h>
+
+#define UI_WAKEUP_MAX_FDS 8
+
+typedef struct {
+    GThread *thread;
+    GMutex mutex;
+    GCond cond;
+    int fds[UI_WAKEUP_MAX_FDS];
+    guint fd_count;
+    int control_fd;
+    gboolean armed;
+    gboolean quit;
+} UIWakeup;
+
+void ui_wakeup_init(UIWakeup *wakeup);
+void ui_wakeup_free(UIWakeup *wakeup);
+bool ui_wakeup_arm(UIWakeup *wakeup, const int *fds, guint count);
+void ui_wakeup_disarm(UIWakeup *wakeup);
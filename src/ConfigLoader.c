@@ -1,4 +1,5 @@
 #include "ConfigLoader.h"
+#include "Trace.h"
 #include <glib.h>
 #include <stdio.h>
 
@@ -19,6 +20,7 @@ void config_free(Config *config) {
 }
 
 void config_load(Config *config, const char *path) {
+    TRACE_SCOPE("config_load");
     (void)config;
     (void)path;
 }
@@ -0,0 +1,280 @@
+#define _GNU_SOURCE
+#include "Daemon.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <glib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define DAEMON_IO_TIMEOUT_MS 200
+
+static const char *command_names[] = {
+    [DAEMON_COMMAND_NONE] = "",
+    [DAEMON_COMMAND_SHOW] = "show",
+    [DAEMON_COMMAND_HIDE] = "hide",
+    [DAEMON_COMMAND_TOGGLE] = "toggle",
+    [DAEMON_COMMAND_STATUS] = "status",
+    [DAEMON_COMMAND_QUIT] = "quit"
+};
+
+static char *runtime_path(const char *name) {
+    return g_build_filename(g_get_user_runtime_dir(), name, NULL);
+}
+
+static bool fill_address(struct sockaddr_un *addr, const char *path) {
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr->sun_path))
+        return false;
+    strcpy(addr->sun_path, path);
+    return true;
+}
+
+static void set_io_timeout(int fd) {
+    struct timeval timeout = {
+        .tv_sec = 0,
+        .tv_usec = DAEMON_IO_TIMEOUT_MS * 1000
+    };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+}
+
+static ssize_t read_line(int fd, char *buffer, size_t size) {
+    size_t len = 0;
+    while (len + 1 < size) {
+        ssize_t n = read(fd, buffer + len, 1);
+        if (n <= 0)
+            break;
+        if (buffer[len] == '\n')
+            break;
+        len++;
+    }
+    buffer[len] = '\0';
+    return (ssize_t)len;
+}
+
+static bool write_line(int fd, const char *text) {
+    gchar *line = g_strconcat(text, "\n", NULL);
+    size_t len = strlen(line);
+    bool ok = send(fd, line, len, MSG_NOSIGNAL) == (ssize_t)len;
+    g_free(line);
+    return ok;
+}
+
+const char *daemon_command_name(DaemonCommand command) {
+    if ((size_t)command >= G_N_ELEMENTS(command_names))
+        return "";
+    return command_names[command];
+}
+
+DaemonCommand daemon_command_parse(const char *name) {
+    if (!name || !*name)
+        return DAEMON_COMMAND_NONE;
+
+    for (size_t i = 1; i < G_N_ELEMENTS(command_names); i++) {
+        if (strcmp(name, command_names[i]) == 0)
+            return (DaemonCommand)i;
+    }
+    return DAEMON_COMMAND_NONE;
+}
+
+void daemon_server_init(DaemonServer *server) {
+    if (!server)
+        return;
+    server->lock_fd = -1;
+    server->listen_fd = -1;
+    server->client_fd = -1;
+    server->socket_path = NULL;
+    for (size_t i = 0; i < DAEMON_MAX_PENDING; i++)
+        server->pending[i].fd = -1;
+}
+
+bool daemon_server_open(DaemonServer *server) {
+    if (!server)
+        return false;
+
+    char *lock_path = runtime_path("waycast.lock");
+    server->lock_fd = open(lock_path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    g_free(lock_path);
+    if (server->lock_fd < 0)
+        return false;
+
+    if (flock(server->lock_fd, LOCK_EX | LOCK_NB) != 0) {
+        close(server->lock_fd);
+        server->lock_fd = -1;
+        return false;
+    }
+
+    server->socket_path = runtime_path("waycast.sock");
+    struct sockaddr_un addr;
+    if (!fill_address(&addr, server->socket_path))
+        return true;
+
+    unlink(server->socket_path);
+    server->listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (server->listen_fd < 0)
+        return true;
+
+    if (bind(server->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        listen(server->listen_fd, 4) != 0) {
+        close(server->listen_fd);
+        server->listen_fd = -1;
+    }
+    return true;
+}
+
+void daemon_server_close(DaemonServer *server) {
+    if (!server)
+        return;
+
+    daemon_server_reply(server, NULL);
+    for (size_t i = 0; i < DAEMON_MAX_PENDING; i++) {
+        if (server->pending[i].fd >= 0)
+            close(server->pending[i].fd);
+        server->pending[i].fd = -1;
+    }
+    if (server->listen_fd >= 0) {
+        close(server->listen_fd);
+        unlink(server->socket_path);
+    }
+    if (server->lock_fd >= 0)
+        close(server->lock_fd);
+
+    g_clear_pointer(&server->socket_path, g_free);
+    server->listen_fd = -1;
+    server->lock_fd = -1;
+}
+
+int daemon_server_fd(const DaemonServer *server) {
+    return server ? server->listen_fd : -1;
+}
+
+size_t daemon_server_fds(const DaemonServer *server, int *fds, size_t max) {
+    size_t count = 0;
+    if (!server || server->listen_fd < 0 || max == 0)
+        return 0;
+
+    fds[count++] = server->listen_fd;
+    for (size_t i = 0; i < DAEMON_MAX_PENDING && count < max; i++) {
+        if (server->pending[i].fd >= 0)
+            fds[count++] = server->pending[i].fd;
+    }
+    return count;
+}
+
+static void add_pending(DaemonServer *server, int fd, gint64 now) {
+    DaemonClient *slot = &server->pending[0];
+    for (size_t i = 0; i < DAEMON_MAX_PENDING; i++) {
+        if (server->pending[i].fd < 0) {
+            slot = &server->pending[i];
+            break;
+        }
+        if (server->pending[i].deadline < slot->deadline)
+            slot = &server->pending[i];
+    }
+
+    if (slot->fd >= 0)
+        close(slot->fd);
+    slot->fd = fd;
+    slot->deadline = now + DAEMON_IO_TIMEOUT_MS * G_TIME_SPAN_MILLISECOND;
+    slot->length = 0;
+}
+
+static bool read_pending(DaemonClient *client, gint64 now) {
+    for (;;) {
+        ssize_t n = recv(client->fd, client->line + client->length, sizeof(client->line) - 1 - client->length, 0);
+        if (n > 0) {
+            char *newline = memchr(client->line + client->length, '\n', (size_t)n);
+            client->length += (size_t)n;
+            if (newline) {
+                client->length = (size_t)(newline - client->line);
+                break;
+            }
+            if (client->length + 1 >= sizeof(client->line))
+                break;
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) && now < client->deadline)
+            return false;
+        break;
+    }
+    client->line[client->length] = '\0';
+    return true;
+}
+
+DaemonCommand daemon_server_accept(DaemonServer *server) {
+    if (!server || server->listen_fd < 0)
+        return DAEMON_COMMAND_NONE;
+
+    daemon_server_reply(server, NULL);
+
+    gint64 now = g_get_monotonic_time();
+    int client;
+    while ((client = accept4(server->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0)
+        add_pending(server, client, now);
+
+    for (size_t i = 0; i < DAEMON_MAX_PENDING; i++) {
+        DaemonClient *pending = &server->pending[i];
+        if (pending->fd < 0 || !read_pending(pending, now))
+            continue;
+
+        client = pending->fd;
+        pending->fd = -1;
+        DaemonCommand command = daemon_command_parse(pending->line);
+        if (command == DAEMON_COMMAND_NONE) {
+            write_line(client, "error");
+            close(client);
+            continue;
+        }
+
+        server->client_fd = client;
+        return command;
+    }
+    return DAEMON_COMMAND_NONE;
+}
+
+void daemon_server_reply(DaemonServer *server, const char *reply) {
+    if (!server || server->client_fd < 0)
+        return;
+
+    if (reply)
+        write_line(server->client_fd, reply);
+    close(server->client_fd);
+    server->client_fd = -1;
+}
+
+bool daemon_client_send(DaemonCommand command, char *reply, size_t reply_size) {
+    if (command == DAEMON_COMMAND_NONE)
+        return false;
+
+    char *socket_path = runtime_path("waycast.sock");
+    struct sockaddr_un addr;
+    bool addressed = fill_address(&addr, socket_path);
+    g_free(socket_path);
+    if (!addressed)
+        return false;
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return false;
+
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return false;
+    }
+
+    set_io_timeout(fd);
+    bool sent = write_line(fd, daemon_command_name(command));
+
+    char buffer[64];
+    read_line(fd, buffer, sizeof(buffer));
+    close(fd);
+
+    if (reply && reply_size > 0)
+        g_strlcpy(reply, buffer, reply_size);
+    return sent;
+}
@@ -0,0 +1,24 @@
+#include "DataPath.h"
+#include <glib.h>
+
+static char *existing_path(const char *base, const char *relative) {
+    char *path = g_build_filename(base, "waycast", relative, NULL);
+    if (g_file_test(path, G_FILE_TEST_EXISTS))
+        return path;
+    g_free(path);
+    return NULL;
+}
+
+char *data_path_find(const char *relative) {
+    if (!relative || !*relative)
+        return NULL;
+
+    char *path = existing_path(g_get_user_data_dir(), relative);
+    const char *const *system_dirs = g_get_system_data_dirs();
+    for (guint i = 0; system_dirs && system_dirs[i] && !path; i++)
+        path = existing_path(system_dirs[i], relative);
+
+    if (!path && g_file_test(relative, G_FILE_TEST_EXISTS))
+        path = g_strdup(relative);
+    return path;
+}
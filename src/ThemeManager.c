@@ -1,5 +1,450 @@
+#define _GNU_SOURCE
 #include "ThemeManager.h"
+#include "DataPath.h"
+#include "Trace.h"
+#include <glib/gstdio.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
 
-void theme_manager_apply(const char *theme_name) {
-    (void)theme_name;
+#define THEME_SNAPSHOT_MAGIC "WTHEMEBN"
+#define THEME_SNAPSHOT_VERSION 2
+
+typedef struct {
+    char magic[8];
+    guint32 version;
+    guint32 reserved;
+    gint64 mtime;
+    gint64 size;
+    guint64 path_hash;
+    Palette palette;
+    ThemeMetrics metrics;
+} ThemeSnapshot;
+
+typedef enum {
+    THEME_VALUE_COLOR,
+    THEME_VALUE_BORDER_COLOR,
+    THEME_VALUE_LENGTH
+} ThemeValueKind;
+
+typedef struct {
+    const char *selector;
+    const char *property;
+    ThemeValueKind kind;
+    size_t offset;
+} ThemeBinding;
+
+#define PALETTE_FIELD(field) offsetof(Theme, palette) + offsetof(Palette, field)
+#define METRIC_FIELD(field) offsetof(Theme, metrics) + offsetof(ThemeMetrics, field)
+
+static const ThemeBinding theme_bindings[] = {
+    {"window.waycast-overlay", "background-color", THEME_VALUE_COLOR, PALETTE_FIELD(background)},
+    {"window.waycast-overlay", "background", THEME_VALUE_COLOR, PALETTE_FIELD(background)},
+    {"window.waycast-overlay", "border", THEME_VALUE_BORDER_COLOR, PALETTE_FIELD(window_border)},
+    {"window.waycast-overlay", "padding", THEME_VALUE_LENGTH, METRIC_FIELD(margin)},
+    {"entry", "background-color", THEME_VALUE_COLOR, PALETTE_FIELD(panel)},
+    {"entry", "background", THEME_VALUE_COLOR, PALETTE_FIELD(panel)},
+    {"entry", "border", THEME_VALUE_BORDER_COLOR, PALETTE_FIELD(panel_border)},
+    {"entry", "color", THEME_VALUE_COLOR, PALETTE_FIELD(text)},
+    {"entry", "padding", THEME_VALUE_LENGTH, METRIC_FIELD(search_padding)},
+    {"entry", "font-size", THEME_VALUE_LENGTH, METRIC_FIELD(search_font_size)},
+    {"entry", "min-height", THEME_VALUE_LENGTH, METRIC_FIELD(search_height)},
+    {".app-grid flowboxchild", "margin", THEME_VALUE_LENGTH, METRIC_FIELD(cell_gap)},
+    {".app-grid flowboxchild:selected", "background-color", THEME_VALUE_COLOR, PALETTE_FIELD(highlight)},
+    {".app-grid flowboxchild:selected", "background", THEME_VALUE_COLOR, PALETTE_FIELD(highlight)},
+    {".app-grid flowboxchild:selected", "border", THEME_VALUE_BORDER_COLOR, PALETTE_FIELD(highlight_border)},
+    {".app-item", "min-width", THEME_VALUE_LENGTH, METRIC_FIELD(cell_width)},
+    {".app-item", "min-height", THEME_VALUE_LENGTH, METRIC_FIELD(cell_height)},
+    {".app-name", "font-size", THEME_VALUE_LENGTH, METRIC_FIELD(label_font_size)},
+    {".app-name", "color", THEME_VALUE_COLOR, PALETTE_FIELD(label)},
+};
+
+static const struct {
+    const char *name;
+    Color color;
+} named_colors[] = {
+    {"transparent", {0, 0, 0, 0}},
+    {"black", {0, 0, 0, 255}},
+    {"white", {255, 255, 255, 255}},
+    {"gray", {128, 128, 128, 255}},
+    {"grey", {128, 128, 128, 255}},
+    {"red", {255, 0, 0, 255}},
+    {"green", {0, 128, 0, 255}},
+    {"blue", {0, 0, 255, 255}},
+};
+
+static void theme_defaults(Theme *theme) {
+    theme->palette = (Palette){
+        .background = (Color){0, 0, 0, 255},
+        .panel = (Color){6, 6, 6, 255},
+        .panel_border = (Color){255, 255, 255, 255},
+        .text = (Color){255, 255, 255, 255},
+        .muted_text = (Color){200, 200, 200, 255},
+        .label = (Color){255, 255, 255, 255},
+        .highlight = (Color){20, 20, 20, 255},
+        .highlight_border = (Color){255, 255, 255, 255},
+        .window_border = (Color){0, 0, 0, 0}
+    };
+    theme->metrics = (ThemeMetrics){
+        .margin = 16,
+        .search_height = 44,
+        .search_padding = 12,
+        .search_font_size = 18,
+        .cell_width = 140,
+        .cell_height = 108,
+        .cell_gap = 12,
+        .label_font_size = 16
+    };
+}
+
+void theme_init(Theme *theme) {
+    if (!theme)
+        return;
+
+    memset(theme, 0, sizeof(*theme));
+    theme_defaults(theme);
+}
+
+void theme_free(Theme *theme) {
+    if (!theme)
+        return;
+
+    g_clear_pointer(&theme->name, g_free);
+    g_clear_pointer(&theme->path, g_free);
+}
+
+static guint8 clamp_channel(double value) {
+    return (guint8)CLAMP(value + 0.5, 0.0, 255.0);
+}
+
+static bool parse_color(const char *text, Color *color) {
+    while (g_ascii_isspace(*text))
+        text++;
+
+    if (*text == '#') {
+        size_t len = strspn(text + 1, "0123456789abcdefABCDEF");
+        if (len != 3 && len != 6 && len != 8)
+            return false;
+
+        guint8 channels[4] = {0, 0, 0, 255};
+        for (size_t i = 0; i < (len == 3 ? 3 : len / 2); i++) {
+            int hi = g_ascii_xdigit_value(text[1 + (len == 3 ? i : i * 2)]);
+            int lo = len == 3 ? hi : g_ascii_xdigit_value(text[2 + i * 2]);
+            channels[i] = (guint8)(hi * 16 + lo);
+        }
+        *color = (Color){channels[0], channels[1], channels[2], channels[3]};
+        return true;
+    }
+
+    if (g_str_has_prefix(text, "rgb")) {
+        const char *open = strchr(text, '(');
+        if (!open)
+            return false;
+
+        double values[4] = {0.0, 0.0, 0.0, 1.0};
+        char *end = (char *)open + 1;
+        int count = 0;
+        while (count < 4) {
+            values[count] = g_ascii_strtod(end, &end);
+            if (*end == '%') {
+                values[count] = count < 3 ? values[count] * 2.55 : values[count] / 100.0;
+                end++;
+            }
+            count++;
+            while (g_ascii_isspace(*end))
+                end++;
+            if (*end != ',')
+                break;
+            end++;
+        }
+        if (count < 3 || *end != ')')
+            return false;
+
+        *color = (Color){clamp_channel(values[0]), clamp_channel(values[1]), clamp_channel(values[2]),
+                         clamp_channel(values[3] * 255.0)};
+        return true;
+    }
+
+    for (size_t i = 0; i < G_N_ELEMENTS(named_colors); i++) {
+        size_t len = strlen(named_colors[i].name);
+        if (g_ascii_strncasecmp(text, named_colors[i].name, len) == 0 &&
+            (text[len] == '\0' || g_ascii_isspace(text[len]))) {
+            *color = named_colors[i].color;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool parse_border_color(const char *text, Color *color) {
+    if (strstr(text, "none"))
+        return false;
+
+    const char *ptr = text;
+    while (*ptr) {
+        while (g_ascii_isspace(*ptr))
+            ptr++;
+        if (parse_color(ptr, color))
+            return true;
+
+        const char *next = strpbrk(ptr, " \t(");
+        if (next && *next == '(')
+            next = strchr(next, ')');
+        if (!next)
+            break;
+        ptr = next + 1;
+    }
+    return false;
+}
+
+static bool parse_length(const char *text, gint32 *length) {
+    char *end = NULL;
+    double value = g_ascii_strtod(text, &end);
+    if (end == text)
+        return false;
+
+    while (g_ascii_isspace(*end))
+        end++;
+    if (*end != '\0' && !g_str_has_prefix(end, "px"))
+        return false;
+
+    *length = (gint32)CLAMP(value + 0.5, 0.0, 4096.0);
+    return true;
+}
+
+static void apply_declaration(Theme *theme, const char *selector, const char *property, const char *value) {
+    for (size_t i = 0; i < G_N_ELEMENTS(theme_bindings); i++) {
+        const ThemeBinding *binding = &theme_bindings[i];
+        if (strcmp(binding->selector, selector) != 0 || strcmp(binding->property, property) != 0)
+            continue;
+
+        void *target = (char *)theme + binding->offset;
+        switch (binding->kind) {
+        case THEME_VALUE_COLOR:
+            parse_color(value, (Color *)target);
+            break;
+        case THEME_VALUE_BORDER_COLOR:
+            parse_border_color(value, (Color *)target);
+            break;
+        case THEME_VALUE_LENGTH:
+            parse_length(value, (gint32 *)target);
+            break;
+        }
+    }
+}
+
+static void strip_comments(char *css) {
+    char *out = css;
+    for (char *in = css; *in;) {
+        if (in[0] == '/' && in[1] == '*') {
+            char *end = strstr(in + 2, "*/");
+            if (!end)
+                break;
+            in = end + 2;
+            continue;
+        }
+        *out++ = *in++;
+    }
+    *out = '\0';
+}
+
+static void parse_rule(Theme *theme, char *selectors, char *body) {
+    gchar **selector_list = g_strsplit(selectors, ",", -1);
+    gchar **declarations = g_strsplit(body, ";", -1);
+
+    for (guint d = 0; declarations[d]; d++) {
+        char *colon = strchr(declarations[d], ':');
+        if (!colon)
+            continue;
+
+        *colon = '\0';
+        char *property = g_strstrip(declarations[d]);
+        char *value = g_strstrip(colon + 1);
+        for (guint s = 0; selector_list[s]; s++)
+            apply_declaration(theme, g_strstrip(selector_list[s]), property, value);
+    }
+
+    g_strfreev(declarations);
+    g_strfreev(selector_list);
+}
+
+static Color flatten_color(Color color, Color background) {
+    float alpha = color.a / 255.0f;
+    return (Color){
+        (unsigned char)(color.r * alpha + background.r * (1.0f - alpha) + 0.5f),
+        (unsigned char)(color.g * alpha + background.g * (1.0f - alpha) + 0.5f),
+        (unsigned char)(color.b * alpha + background.b * (1.0f - alpha) + 0.5f),
+        255
+    };
+}
+
+static void finish_theme(Theme *theme) {
+    Palette *palette = &theme->palette;
+    palette->background.a = 255;
+    palette->panel = flatten_color(palette->panel, palette->background);
+    palette->panel_border = flatten_color(palette->panel_border, palette->background);
+    palette->text = flatten_color(palette->text, palette->panel);
+    palette->muted_text = flatten_color(palette->muted_text, palette->panel);
+    palette->label = flatten_color(palette->label, palette->background);
+    palette->highlight = flatten_color(palette->highlight, palette->panel);
+    palette->highlight_border = flatten_color(palette->highlight_border, palette->background);
+    palette->window_border = flatten_color(palette->window_border, palette->background);
+
+    ThemeMetrics *metrics = &theme->metrics;
+    metrics->search_font_size = CLAMP(metrics->search_font_size, 8, 64);
+    metrics->label_font_size = CLAMP(metrics->label_font_size, 8, 64);
+    metrics->search_height = MAX(metrics->search_height, metrics->search_font_size + 8);
+    metrics->cell_width = CLAMP(metrics->cell_width, 64, 512);
+    metrics->cell_height = CLAMP(metrics->cell_height, 64, 512);
+}
+
+static bool parse_theme(Theme *theme, const char *css) {
+    if (!theme || !css)
+        return false;
+
+    theme_defaults(theme);
+    char *text = g_strdup(css);
+    strip_comments(text);
+
+    char *ptr = text;
+    while (*ptr) {
+        char *open = strchr(ptr, '{');
+        if (!open)
+            break;
+        char *close = strchr(open + 1, '}');
+        if (!close)
+            break;
+
+        *open = '\0';
+        *close = '\0';
+        parse_rule(theme, ptr, open + 1);
+        ptr = close + 1;
+    }
+
+    g_free(text);
+    finish_theme(theme);
+    return true;
+}
+
+static guint64 hash_path(const char *path) {
+    guint64 hash = G_GUINT64_CONSTANT(14695981039346656037);
+    for (const guchar *p = (const guchar *)path; *p; p++) {
+        hash ^= *p;
+        hash *= G_GUINT64_CONSTANT(1099511628211);
+    }
+    return hash;
+}
+
+static char *snapshot_path(const char *theme_name) {
+    char *file_name = g_strdup_printf("theme-%s.bin", theme_name);
+    char *path = g_build_filename(g_get_user_cache_dir(), "waycast", file_name, NULL);
+    g_free(file_name);
+    return path;
+}
+
+static bool load_snapshot(Theme *theme, const char *path) {
+    gchar *contents = NULL;
+    gsize length = 0;
+    if (!g_file_get_contents(path, &contents, &length, NULL))
+        return false;
+
+    ThemeSnapshot snapshot;
+    bool ok = length == sizeof(snapshot);
+    if (ok) {
+        memcpy(&snapshot, contents, sizeof(snapshot));
+        ok = memcmp(snapshot.magic, THEME_SNAPSHOT_MAGIC, sizeof(snapshot.magic)) == 0 &&
+             snapshot.version == THEME_SNAPSHOT_VERSION &&
+             snapshot.mtime == theme->mtime &&
+             snapshot.size == theme->size &&
+             snapshot.path_hash == hash_path(theme->path);
+    }
+    if (ok) {
+        theme->palette = snapshot.palette;
+        theme->metrics = snapshot.metrics;
+    }
+
+    g_free(contents);
+    return ok;
+}
+
+static void write_snapshot(const Theme *theme, const char *path) {
+    ThemeSnapshot snapshot;
+    memset(&snapshot, 0, sizeof(snapshot));
+    memcpy(snapshot.magic, THEME_SNAPSHOT_MAGIC, sizeof(snapshot.magic));
+    snapshot.version = THEME_SNAPSHOT_VERSION;
+    snapshot.mtime = theme->mtime;
+    snapshot.size = theme->size;
+    snapshot.path_hash = hash_path(theme->path);
+    snapshot.palette = theme->palette;
+    snapshot.metrics = theme->metrics;
+
+    gchar *dir_path = g_path_get_dirname(path);
+    g_mkdir_with_parents(dir_path, 0700);
+    g_free(dir_path);
+    g_file_set_contents(path, (const gchar *)&snapshot, sizeof(snapshot), NULL);
+}
+
+static bool stat_theme(const char *path, gint64 *mtime, gint64 *size) {
+    GStatBuf st;
+    if (!path || g_stat(path, &st) != 0)
+        return false;
+
+    *mtime = (gint64)st.st_mtim.tv_sec * G_GINT64_CONSTANT(1000000000) + st.st_mtim.tv_nsec;
+    *size = (gint64)st.st_size;
+    return true;
+}
+
+static bool load_theme_file(Theme *theme) {
+    TRACE_SCOPE("theme_load");
+
+    char *cache_path = snapshot_path(theme->name);
+    bool ok = load_snapshot(theme, cache_path);
+    if (!ok) {
+        gchar *css = NULL;
+        ok = g_file_get_contents(theme->path, &css, NULL, NULL) && parse_theme(theme, css);
+        if (ok)
+            write_snapshot(theme, cache_path);
+        g_free(css);
+    }
+
+    g_free(cache_path);
+    return ok;
+}
+
+bool theme_manager_load(Theme *theme, const char *theme_name) {
+    if (!theme)
+        return false;
+
+    if (!theme_name || !*theme_name || strchr(theme_name, G_DIR_SEPARATOR))
+        theme_name = "default";
+
+    g_free(theme->name);
+    g_free(theme->path);
+    theme->name = g_strdup(theme_name);
+    char *relative = g_build_filename("themes", theme_name, "style.css", NULL);
+    theme->path = data_path_find(relative);
+    g_free(relative);
+
+    theme_defaults(theme);
+    if (!stat_theme(theme->path, &theme->mtime, &theme->size)) {
+        theme->mtime = 0;
+        theme->size = 0;
+        return false;
+    }
+    return load_theme_file(theme);
+}
+
+bool theme_manager_reload(Theme *theme) {
+    if (!theme || !theme->path)
+        return false;
+
+    gint64 mtime = 0;
+    gint64 size = 0;
+    if (!stat_theme(theme->path, &mtime, &size) || (mtime == theme->mtime && size == theme->size))
+        return false;
+
+    theme->mtime = mtime;
+    theme->size = size;
+    load_theme_file(theme);
+    return true;
 }
@@ -0,0 +1,130 @@
+#include "Trace.h"
+#include <stdio.h>
+
+#define TRACE_MAX_EVENTS (1u << 18)
+
+typedef struct {
+    const char *name;
+    gint64 ts;
+    gint64 dur;
+    guint32 tid;
+    char phase;
+} TraceEvent;
+
+bool trace_active = false;
+
+static GMutex trace_lock;
+static GArray *trace_events = NULL;
+static char *trace_path = NULL;
+static gint64 trace_origin = 0;
+static guint trace_dropped = 0;
+static bool trace_overlay = false;
+static gint trace_next_tid = 0;
+static _Thread_local guint32 trace_tid = 0;
+
+static guint32 current_tid(void) {
+    if (trace_tid == 0)
+        trace_tid = (guint32)g_atomic_int_add(&trace_next_tid, 1) + 1;
+    return trace_tid;
+}
+
+static void append_event(const char *name, gint64 ts, gint64 dur, char phase) {
+    TraceEvent event = {
+        .name = name,
+        .ts = ts - trace_origin,
+        .dur = dur,
+        .tid = current_tid(),
+        .phase = phase
+    };
+
+    g_mutex_lock(&trace_lock);
+    if (trace_events && trace_events->len < TRACE_MAX_EVENTS)
+        g_array_append_val(trace_events, event);
+    else
+        trace_dropped++;
+    g_mutex_unlock(&trace_lock);
+}
+
+static bool env_flag(const char *name) {
+    const char *value = g_getenv(name);
+    return value && *value && g_strcmp0(value, "0") != 0;
+}
+
+bool trace_init(const char *path, bool overlay) {
+    trace_origin = g_get_monotonic_time();
+    trace_overlay = overlay || env_flag(TRACE_OVERLAY_ENV);
+
+    if (!path || !*path)
+        path = g_getenv(TRACE_ENV);
+    if (!path || !*path)
+        return false;
+
+    trace_path = g_strdup(path);
+    trace_events = g_array_sized_new(FALSE, FALSE, sizeof(TraceEvent), 4096);
+    trace_active = true;
+    return true;
+}
+
+bool trace_overlay_enabled(void) {
+    return trace_overlay;
+}
+
+gint64 trace_now(void) {
+    return g_get_monotonic_time();
+}
+
+void trace_record(const char *name, gint64 start, gint64 end) {
+    if (!trace_active || !name)
+        return;
+    append_event(name, start, end - start, 'X');
+}
+
+void trace_instant(const char *name) {
+    if (!trace_active || !name)
+        return;
+    append_event(name, trace_now(), 0, 'i');
+}
+
+static void append_json_string(GString *json, const char *text) {
+    g_string_append_c(json, '"');
+    for (const char *ptr = text; *ptr; ptr++) {
+        if (*ptr == '"' || *ptr == '\\')
+            g_string_append_c(json, '\\');
+        g_string_append_c(json, *ptr);
+    }
+    g_string_append_c(json, '"');
+}
+
+void trace_shutdown(void) {
+    if (!trace_active)
+        return;
+
+    trace_active = false;
+    g_mutex_lock(&trace_lock);
+    GArray *events = trace_events;
+    trace_events = NULL;
+    g_mutex_unlock(&trace_lock);
+
+    GString *json = g_string_new("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    g_string_append_printf(json, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"waycast\"}}");
+    for (guint i = 0; i < events->len; i++) {
+        const TraceEvent *event = &g_array_index(events, TraceEvent, i);
+        g_string_append(json, ",\n{\"name\":");
+        append_json_string(json, event->name);
+        g_string_append_printf(json, ",\"ph\":\"%c\",\"ts\":%" G_GINT64_FORMAT ",\"pid\":1,\"tid\":%u",
+                               event->phase, event->ts, event->tid);
+        if (event->phase == 'X')
+            g_string_append_printf(json, ",\"dur\":%" G_GINT64_FORMAT, event->dur);
+        else
+            g_string_append(json, ",\"s\":\"t\"");
+        g_string_append_c(json, '}');
+    }
+    g_string_append_printf(json, "\n],\"otherData\":{\"dropped_events\":%u}}\n", trace_dropped);
+
+    if (!g_file_set_contents(trace_path, json->str, (gssize)json->len, NULL))
+        fprintf(stderr, "waycast: could not write trace to %s\n", trace_path);
+
+    g_string_free(json, TRUE);
+    g_array_free(events, TRUE);
+    g_clear_pointer(&trace_path, g_free);
+}
@@ -1,47 +1,26 @@
+#define _GNU_SOURCE
 #include "UIManager.h"
+#include "ThemeManager.h"
+#include "Trace.h"
 #include "ui/ui_app_data.h"
 #include "ui/ui_app_grid.h"
+#include "ui/ui_app_history.h"
+#include "ui/ui_app_loader.h"
+#include "ui/ui_app_watch.h"
+#include "ui/ui_file_indexer.h"
+#include "ui/ui_glyph_atlas.h"
+#include "ui/ui_icon_cache.h"
+#include "ui/ui_line_reader.h"
 #include "ui/ui_search_bar.h"
+#include "ui/ui_search_worker.h"
+#include "ui/ui_trace_overlay.h"
+#include "ui/ui_wakeup.h"
+#include <poll.h>
 #include <raylib.h>
 #include <stdbool.h>
+#include <stdio.h>
 #include <string.h>
 
-typedef struct {
-    Color background;
-    Color panel;
-    Color panel_border;
-    Color text;
-    Color muted_text;
-    Color highlight;
-    Color highlight_border;
-} Palette;
-
-static Palette palette_from_theme(const char *theme_name) {
-    const bool light = (theme_name && strcmp(theme_name, "light") == 0);
-
-    if (light) {
-        return (Palette){
-            .background = (Color){245, 243, 238, 255},
-            .panel = (Color){255, 255, 255, 255},
-            .panel_border = (Color){214, 206, 197, 255},
-            .text = (Color){26, 25, 24, 255},
-            .muted_text = (Color){104, 98, 91, 255},
-            .highlight = (Color){238, 228, 210, 255},
-            .highlight_border = (Color){190, 176, 160, 255}
-        };
-    }
-
-    return (Palette){
-        .background = (Color){0, 0, 0, 255},
-        .panel = (Color){6, 6, 6, 255},
-        .panel_border = (Color){255, 255, 255, 255},
-        .text = (Color){255, 255, 255, 255},
-        .muted_text = (Color){200, 200, 200, 255},
-        .highlight = (Color){20, 20, 20, 255},
-        .highlight_border = (Color){255, 255, 255, 255}
-    };
-}
-
 static void center_window(int width, int height) {
     const int monitor = GetCurrentMonitor();
     int x = (GetMonitorWidth(monitor) - width) / 2;
@@ -53,53 +32,279 @@ static void center_window(int width, int height) {
     SetWindowPosition(x, y);
 }
 
-void ui_manager_start(const Config *config) {
-    (void)config;
+#define IDLE_POLL_TIMEOUT_MS 15
+#define ACTIVE_GRACE_FRAMES 12
+
+static guint wakeup_fds(const DaemonServer *server, const UIAppWatch *watch, const UIAppLoader *loader,
+                        const UILineReader *reader, const UIFileIndexer *indexer, int *fds) {
+    const int candidates[] = {
+        ui_app_watch_fd(watch),
+        ui_app_loader_fd(loader),
+        ui_line_reader_fd(reader),
+        ui_file_indexer_fd(indexer)
+    };
+    guint count = (guint)daemon_server_fds(server, fds, UI_WAKEUP_MAX_FDS - G_N_ELEMENTS(candidates));
+    for (guint i = 0; i < G_N_ELEMENTS(candidates); i++) {
+        if (candidates[i] >= 0)
+            fds[count++] = candidates[i];
+    }
+    return count;
+}
+
+static void wait_for_wakeup(const DaemonServer *server, const UIAppWatch *watch, const UIAppLoader *loader,
+                            const UILineReader *reader, const UIFileIndexer *indexer, int timeout_ms) {
+    int fds[UI_WAKEUP_MAX_FDS];
+    struct pollfd pfds[UI_WAKEUP_MAX_FDS];
+    guint count = wakeup_fds(server, watch, loader, reader, indexer, fds);
+    for (guint i = 0; i < count; i++)
+        pfds[i] = (struct pollfd){.fd = fds[i], .events = POLLIN};
+
+    if (count > 0)
+        poll(pfds, count, timeout_ms);
+}
+
+static void wait_for_input(UIWakeup *wakeup, const DaemonServer *server, const UIAppWatch *watch,
+                           const UIAppLoader *loader, const UILineReader *reader, const UIFileIndexer *indexer) {
+    int fds[UI_WAKEUP_MAX_FDS];
+    guint count = wakeup_fds(server, watch, loader, reader, indexer, fds);
+    if (count > 0 && !ui_wakeup_arm(wakeup, fds, count)) {
+        wait_for_wakeup(server, watch, loader, reader, indexer, IDLE_POLL_TIMEOUT_MS);
+        PollInputEvents();
+        return;
+    }
+
+    EnableEventWaiting();
+    PollInputEvents();
+    DisableEventWaiting();
+    ui_wakeup_disarm(wakeup);
+}
+
+static void set_window_visible(bool *visible, bool want_visible, UISearchBar *search, UIAppGrid *grid) {
+    if (*visible == want_visible)
+        return;
+
+    *visible = want_visible;
+    if (want_visible) {
+        ClearWindowState(FLAG_WINDOW_HIDDEN);
+        center_window(GetScreenWidth(), GetScreenHeight());
+        SetWindowFocused();
+    } else {
+        SetWindowState(FLAG_WINDOW_HIDDEN);
+        ui_search_bar_init(search);
+        ui_app_grid_reset(grid, 0);
+    }
+}
+
+static void log_to_stderr(int level, const char *text, va_list args) {
+    if (level < LOG_WARNING)
+        return;
+    vfprintf(stderr, text, args);
+    fputc('\n', stderr);
+}
+
+static void unmap_window(bool *visible, bool resident, UISearchBar *search, UIAppGrid *grid) {
+    if (resident)
+        set_window_visible(visible, false, search, grid);
+    else
+        SetWindowState(FLAG_WINDOW_HIDDEN);
+    PollInputEvents();
+}
+
+bool ui_manager_start(const Config *config, DaemonServer *server, bool resident, int dmenu_input) {
     const int initial_width = 1000;
     const int initial_height = 600;
+    const bool dmenu = dmenu_input >= 0;
 
     UIAppData data;
     ui_app_data_init(&data);
-    ui_app_data_load(&data);
+
+    UIAppLoader loader;
+    UILineReader reader;
+    UIFileIndexer indexer = {0};
+    UIAppHistory history;
+    ui_app_history_init(&history);
+    UIAppWatch watch;
+    ui_app_watch_init(&watch);
+    if (dmenu) {
+        ui_app_loader_init(&loader);
+        ui_line_reader_start(&reader, &data.lines, dmenu_input);
+    } else {
+        ui_app_data_load_files(&data);
+        ui_app_watch_open(&watch);
+        ui_app_loader_start(&loader, watch.fd);
+        ui_line_reader_init(&reader);
+        ui_app_history_load(&history);
+        ui_file_indexer_init(&indexer);
+    }
 
     UISearchBar search;
     ui_search_bar_init(&search);
 
+    UISearchWorker searcher;
+    ui_search_worker_init(&searcher, &data, dmenu ? UI_PROVIDER_MASK(UI_PROVIDER_LINES) : UI_PROVIDER_LAUNCHER);
+    bool reset_selection = false;
+    bool lines_pending = false;
+    bool selected = false;
+
     UIAppGrid grid;
     ui_app_grid_init(&grid);
 
-    Palette palette = palette_from_theme("default");
+    Theme theme;
+    theme_init(&theme);
+    theme_manager_load(&theme, config ? config->theme : NULL);
 
-    SetConfigFlags(FLAG_WINDOW_RESIZABLE);
+    bool visible = !resident;
+    if (dmenu)
+        SetTraceLogCallback(log_to_stderr);
+    SetConfigFlags(FLAG_WINDOW_RESIZABLE | (visible ? 0 : FLAG_WINDOW_HIDDEN));
     InitWindow(initial_width, initial_height, "Waycast");
     center_window(initial_width, initial_height);
+    SetExitKey(0);
     SetTargetFPS(60);
 
-    Font ui_font = LoadFontEx("fonts/SFMono-Regular.otf", 32, NULL, 0);
-    bool has_font = (ui_font.texture.id != 0);
+    UIIconCache icons;
+    ui_icon_cache_init(&icons);
+
+    UIGlyphAtlas glyphs;
+    ui_glyph_atlas_init(&glyphs);
+    ui_glyph_atlas_open(&glyphs, "fonts/SFMono-Regular.otf");
+
+    UIWakeup wakeup;
+    ui_wakeup_init(&wakeup);
 
-    const int margin = 16;
-    const int search_height = 44;
-    const int cell_width = 140;
-    const int cell_height = 108;
-    const int cell_gap = 12;
+    UITraceOverlay overlay;
+    ui_trace_overlay_init(&overlay);
+    const bool show_overlay = trace_overlay_enabled();
+    bool first_frame = true;
+
+    int active_frames = ACTIVE_GRACE_FRAMES;
+    bool running = true;
+    while (running) {
+        if (!visible)
+            wait_for_wakeup(server, &watch, &loader, &reader, &indexer, ui_app_loader_ready(&loader) ? 0 : -1);
+        else if (active_frames == 0 && !ui_icon_cache_pending(&icons) && !ui_search_worker_pending(&searcher) &&
+                 !ui_app_loader_ready(&loader) && !lines_pending)
+            wait_for_input(&wakeup, server, &watch, &loader, &reader, &indexer);
+
+        const gint64 frame_start = trace_now();
+        TraceSpan input_span = trace_span_begin("input");
+
+        bool want_visible = visible;
+        switch (daemon_server_accept(server)) {
+        case DAEMON_COMMAND_SHOW:
+            want_visible = true;
+            break;
+        case DAEMON_COMMAND_HIDE:
+            want_visible = false;
+            break;
+        case DAEMON_COMMAND_TOGGLE:
+            want_visible = !visible;
+            break;
+        case DAEMON_COMMAND_QUIT:
+            running = false;
+            break;
+        case DAEMON_COMMAND_STATUS:
+        case DAEMON_COMMAND_NONE:
+            break;
+        }
+
+        bool catalog_changed = false;
+        if (ui_app_loader_ready(&loader) && ui_search_worker_lock_catalog(&searcher, false)) {
+            catalog_changed = ui_app_loader_poll(&loader, &data);
+            if (ui_app_loader_finished(&loader) && ui_app_watch_start(&watch, &data))
+                catalog_changed = true;
+            if (catalog_changed)
+                ui_app_history_apply(&history, &data);
+            ui_search_worker_unlock_catalog(&searcher);
+        }
+        if (ui_app_watch_ready(&watch) && ui_search_worker_lock_catalog(&searcher, false)) {
+            if (ui_app_watch_poll(&watch, &data)) {
+                ui_app_history_apply(&history, &data);
+                catalog_changed = true;
+                if (!ui_path_index_valid(&data.commands))
+                    ui_file_indexer_request_commands(&indexer);
+            }
+            ui_search_worker_unlock_catalog(&searcher);
+        }
+        if (ui_file_indexer_ready(&indexer) && ui_search_worker_lock_catalog(&searcher, false)) {
+            if (ui_file_indexer_take(&indexer) && ui_app_data_load_files(&data))
+                catalog_changed = catalog_changed || ui_app_data_is_file_query(search.text);
+            ui_search_worker_unlock_catalog(&searcher);
+        }
+        if (ui_file_indexer_commands_ready(&indexer) && ui_search_worker_lock_catalog(&searcher, false)) {
+            UIPathIndex commands;
+            if (ui_file_indexer_take_commands(&indexer, &commands)) {
+                ui_app_data_set_commands(&data, &commands);
+                catalog_changed = catalog_changed || ui_app_data_is_command_query(search.text);
+            }
+            ui_search_worker_unlock_catalog(&searcher);
+        }
+        if (ui_line_reader_poll(&reader))
+            lines_pending = true;
+        if (!running || (!want_visible && !resident)) {
+            daemon_server_reply(server, running ? "hidden" : "stopped");
+            break;
+        }
+
+        bool dirty = catalog_changed || visible != want_visible;
+        if (resident && want_visible && !visible) {
+            theme_manager_reload(&theme);
+            ui_icon_cache_refresh(&icons);
+        }
+        set_window_visible(&visible, want_visible, &search, &grid);
+        daemon_server_reply(server, visible ? "visible" : "hidden");
+
+        if (!visible) {
+            ui_glyph_atlas_save(&glyphs);
+            continue;
+        }
+
+        if (WindowShouldClose()) {
+            if (!resident)
+                break;
+            set_window_visible(&visible, false, &search, &grid);
+            continue;
+        }
 
-    while (!WindowShouldClose()) {
         if (IsWindowResized()) {
             center_window(GetScreenWidth(), GetScreenHeight());
+            dirty = true;
         }
 
         bool should_close = false;
         ui_search_bar_handle_input(&search, &should_close);
-        if (should_close)
-            break;
+        if (search.dirty)
+            ui_trace_overlay_input(&overlay, frame_start);
 
-        if (search.dirty) {
-            ui_app_data_filter(&data, search.text);
-            ui_app_grid_reset(&grid, ui_app_data_filtered_count(&data));
+        if (search.dirty || catalog_changed || (lines_pending && !ui_search_worker_pending(&searcher))) {
+            dirty = true;
+            reset_selection = reset_selection || search.dirty;
+            lines_pending = false;
+            if (ui_app_data_is_file_query(search.text))
+                ui_file_indexer_request(&indexer);
+            if (ui_app_data_is_command_query(search.text) && ui_app_loader_finished(&loader) &&
+                !ui_path_index_valid(&data.commands))
+                ui_file_indexer_request_commands(&indexer);
+            ui_search_worker_submit(&searcher, search.text);
             search.dirty = false;
         }
 
+        if (ui_search_worker_poll(&searcher, &data)) {
+            dirty = true;
+            if (reset_selection)
+                ui_app_grid_reset(&grid, ui_app_data_filtered_count(&data));
+            else
+                ui_app_grid_clamp(&grid, ui_app_data_filtered_count(&data));
+            reset_selection = false;
+        }
+
+        const ThemeMetrics *metrics = &theme.metrics;
+        const Palette *palette = &theme.palette;
+        const int margin = metrics->margin;
+        const int search_height = metrics->search_height;
+        const int cell_width = metrics->cell_width;
+        const int cell_height = metrics->cell_height;
+        const int cell_gap = metrics->cell_gap;
         const int width = GetScreenWidth();
         const int height = GetScreenHeight();
         int available_width = width - margin * 2;
@@ -115,21 +320,68 @@ void ui_manager_start(const Config *config) {
         if (max_scroll < 0.0f)
             max_scroll = 0.0f;
 
+        const int prev_selected = grid.selected_index;
+        const float prev_scroll = grid.scroll_y;
+        Rectangle grid_viewport = {
+            (float)margin,
+            grid_top,
+            (float)available_width,
+            viewport_height
+        };
+
         ui_app_grid_handle_navigation(&grid, cols, filtered_count);
+        ui_app_grid_handle_mouse(&grid, grid_viewport, cols, cell_width, cell_height, cell_gap, filtered_count);
         ui_app_grid_handle_scroll(&grid, max_scroll);
         ui_app_grid_ensure_visible(&grid, cols, viewport_height, cell_height, cell_gap);
+        if (grid.selected_index != prev_selected || grid.scroll_y != prev_scroll) {
+            ui_trace_overlay_input(&overlay, frame_start);
+            dirty = true;
+        }
+        trace_span_end(&input_span);
 
         if (IsKeyPressed(KEY_ENTER) || IsKeyPressed(KEY_KP_ENTER)) {
-            if (grid.selected_index >= 0 && grid.selected_index < (int)filtered_count) {
-                guint app_idx = ui_app_data_filtered_index(&data, (guint)grid.selected_index);
-                const App *app = ui_app_data_get(&data, app_idx);
-                ui_app_launch(app);
-                break;
+            const App *app = grid.selected_index >= 0 && grid.selected_index < (int)filtered_count
+                                 ? ui_app_data_filtered_app(&data, (guint)grid.selected_index)
+                                 : NULL;
+            const char *choice = app ? app->name : search.text;
+            if (dmenu && choice && *choice) {
+                printf("%s\n", choice);
+                fflush(stdout);
+                selected = true;
+                should_close = true;
+            } else if (!dmenu && app) {
+                unmap_window(&visible, resident, &search, &grid);
+                if (ui_app_launch(app) && app->id) {
+                    ui_app_history_record(&history, app);
+                    ui_search_worker_lock_catalog(&searcher, true);
+                    ui_app_history_apply(&history, &data);
+                    ui_search_worker_unlock_catalog(&searcher);
+                }
+                should_close = true;
             }
         }
 
+        if (should_close) {
+            if (!resident)
+                break;
+            set_window_visible(&visible, false, &search, &grid);
+            continue;
+        }
+
+        if (ui_icon_cache_update(&icons))
+            dirty = true;
+
+        if (dirty)
+            active_frames = ACTIVE_GRACE_FRAMES;
+        else if (active_frames > 0)
+            active_frames--;
+        else if (!ui_icon_cache_pending(&icons) && !ui_search_worker_pending(&searcher))
+            continue;
+
+        TraceSpan frame_span = trace_span_begin("frame");
         BeginDrawing();
-        ClearBackground(palette.background);
+        ClearBackground(palette->background);
+        DrawRectangleLinesEx((Rectangle){0.0f, 0.0f, (float)width, (float)height}, 1.0f, palette->window_border);
 
         Rectangle search_rect = {
             (float)margin,
@@ -137,29 +389,47 @@ void ui_manager_start(const Config *config) {
             (float)(width - margin * 2),
             (float)search_height
         };
-        ui_search_bar_draw(&search, search_rect, ui_font, has_font,
-                           palette.text, palette.muted_text,
-                           palette.panel, palette.panel_border);
+        ui_search_bar_draw(&search, search_rect, &glyphs,
+                           metrics->search_font_size, metrics->search_padding,
+                           palette->text, palette->muted_text,
+                           palette->panel, palette->panel_border);
 
-        Rectangle grid_viewport = {
-            (float)margin,
-            grid_top,
-            (float)available_width,
-            viewport_height
-        };
+        ui_app_grid_draw(&grid, &data, &icons, grid_viewport, cols, cell_width, cell_height,
+                         cell_gap, &glyphs, metrics->label_font_size,
+                         palette->panel, palette->panel_border,
+                         palette->highlight, palette->highlight_border,
+                         palette->label);
 
-        ui_app_grid_draw(&grid, &data, grid_viewport, cols, cell_width, cell_height,
-                         cell_gap, ui_font, has_font,
-                         palette.panel, palette.panel_border,
-                         palette.highlight, palette.highlight_border,
-                         palette.text);
+        if (show_overlay)
+            ui_trace_overlay_draw(&overlay, (Rectangle){0.0f, 0.0f, (float)width, (float)height},
+                                  &glyphs, palette->text, palette->panel);
 
+        TraceSpan present_span = trace_span_begin("EndDrawing");
         EndDrawing();
+        trace_span_end(&present_span);
+        trace_span_end(&frame_span);
+
+        ui_trace_overlay_frame(&overlay, frame_start, trace_now());
+        if (first_frame) {
+            trace_instant("first_frame");
+            first_frame = false;
+        }
     }
 
-    if (has_font)
-        UnloadFont(ui_font);
+    ui_glyph_atlas_save(&glyphs);
+    ui_glyph_atlas_free(&glyphs);
 
+    ui_wakeup_free(&wakeup);
+    ui_search_worker_free(&searcher);
+    ui_app_loader_free(&loader);
+    ui_line_reader_free(&reader);
+    ui_file_indexer_free(&indexer);
+    ui_icon_cache_free(&icons);
+    ui_app_grid_free(&grid);
+    ui_app_watch_stop(&watch);
+    ui_app_history_free(&history);
     ui_app_data_free(&data);
+    theme_free(&theme);
     CloseWindow();
+    return selected || !dmenu;
 }
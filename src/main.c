@@ -1,16 +1,117 @@
 #include "ConfigLoader.h"
+#include "Daemon.h"
+#include "Trace.h"
 #include "UIManager.h"
+#include <glib.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <unistd.h>
+
+typedef struct {
+    gboolean daemon;
+    gboolean show;
+    gboolean hide;
+    gboolean toggle;
+    gboolean status;
+    gboolean quit;
+    gchar *trace;
+    gboolean trace_overlay;
+    gboolean dmenu;
+} Options;
+
+static DaemonCommand requested_command(const Options *options) {
+    if (options->show)
+        return DAEMON_COMMAND_SHOW;
+    if (options->hide)
+        return DAEMON_COMMAND_HIDE;
+    if (options->toggle)
+        return DAEMON_COMMAND_TOGGLE;
+    if (options->status)
+        return DAEMON_COMMAND_STATUS;
+    if (options->quit)
+        return DAEMON_COMMAND_QUIT;
+    return DAEMON_COMMAND_NONE;
+}
+
+static bool parse_options(int *argc, char ***argv, Options *options) {
+    GOptionEntry entries[] = {
+        {"daemon", 'd', 0, G_OPTION_ARG_NONE, &options->daemon, "Stay resident and hide between uses", NULL},
+        {"show", 0, 0, G_OPTION_ARG_NONE, &options->show, "Show the running instance", NULL},
+        {"hide", 0, 0, G_OPTION_ARG_NONE, &options->hide, "Hide the running instance", NULL},
+        {"toggle", 0, 0, G_OPTION_ARG_NONE, &options->toggle, "Toggle the running instance", NULL},
+        {"status", 0, 0, G_OPTION_ARG_NONE, &options->status, "Print whether the running instance is visible", NULL},
+        {"quit", 0, 0, G_OPTION_ARG_NONE, &options->quit, "Stop the running instance", NULL},
+        {"trace", 0, 0, G_OPTION_ARG_FILENAME, &options->trace, "Write a Chrome trace to FILE on exit (or set " TRACE_ENV ")", "FILE"},
+        {"trace-overlay", 0, 0, G_OPTION_ARG_NONE, &options->trace_overlay, "Show frame time and input latency on screen", NULL},
+        {"dmenu", 0, 0, G_OPTION_ARG_NONE, &options->dmenu, "Read items from stdin and print the chosen one", NULL},
+        G_OPTION_ENTRY_NULL
+    };
+
+    GOptionContext *context = g_option_context_new(NULL);
+    g_option_context_add_main_entries(context, entries, NULL);
+
+    GError *error = NULL;
+    bool ok = g_option_context_parse(context, argc, argv, &error);
+    if (!ok) {
+        g_printerr("waycast: %s\n", error->message);
+        g_error_free(error);
+    }
+    g_option_context_free(context);
+    return ok;
+}
 
 int main(int argc, char *argv[]) {
+    Options options = {0};
+    if (!parse_options(&argc, &argv, &options))
+        return EXIT_FAILURE;
+
+    DaemonCommand command = requested_command(&options);
+    if (command != DAEMON_COMMAND_NONE) {
+        char reply[64];
+        if (!daemon_client_send(command, reply, sizeof(reply))) {
+            g_printerr("waycast: no running instance\n");
+            return EXIT_FAILURE;
+        }
+        if (command == DAEMON_COMMAND_STATUS)
+            printf("%s\n", reply);
+        return EXIT_SUCCESS;
+    }
+
+    if (options.dmenu && options.daemon) {
+        g_printerr("waycast: --dmenu cannot be combined with --daemon\n");
+        return EXIT_FAILURE;
+    }
+    if (!options.daemon && !options.dmenu && daemon_client_send(DAEMON_COMMAND_TOGGLE, NULL, 0))
+        return EXIT_SUCCESS;
+
+    trace_init(options.trace, options.trace_overlay);
+    g_free(options.trace);
+    TraceSpan main_span = trace_span_begin("main");
+
+    DaemonServer server;
+    daemon_server_init(&server);
+    if (!options.dmenu && !daemon_server_open(&server)) {
+        g_printerr("waycast: another instance is already running\n");
+        trace_shutdown();
+        return EXIT_FAILURE;
+    }
+    if (options.daemon && daemon_server_fd(&server) < 0) {
+        g_printerr("waycast: could not open control socket\n");
+        daemon_server_close(&server);
+        trace_shutdown();
+        return EXIT_FAILURE;
+    }
+
     Config config;
     config_init(&config);
     config_load(&config, NULL);
 
-    (void)argc;
-    (void)argv;
+    bool selected = ui_manager_start(&config, options.dmenu ? NULL : &server, options.daemon,
+                                     options.dmenu ? STDIN_FILENO : -1);
 
-    ui_manager_start(&config);
     config_free(&config);
-    return 0;
+    daemon_server_close(&server);
+    trace_span_end(&main_span);
+    trace_shutdown();
+    return selected ? EXIT_SUCCESS : EXIT_FAILURE;
 }
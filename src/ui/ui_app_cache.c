@@ -0,0 +1,462 @@
+#include "ui/ui_app_cache.h"
+#include "ui/ui_fuzzy.h"
+#include <string.h>
+
+#define CACHE_MAGIC "WCATALOG"
+#define CACHE_VERSION 4
+#define CACHE_NO_STRING G_MAXUINT32
+#define CACHE_NO_PARENT G_MAXUINT32
+
+typedef struct {
+    char magic[8];
+    guint32 version;
+    guint32 dir_count;
+    guint32 entry_count;
+    guint32 trigram_count;
+    guint32 posting_count;
+    guint32 strings_size;
+} CacheHeader;
+
+typedef struct {
+    gint64 mtime;
+    guint32 path;
+    guint32 parent;
+    guint32 first_entry;
+    guint32 entry_count;
+    guint32 reserved;
+} CacheDir;
+
+typedef struct {
+    gint64 mtime;
+    gint64 size;
+    guint32 file;
+    guint32 flags;
+    guint32 name;
+    guint32 exec;
+    guint32 icon;
+    guint32 generic_name;
+    guint32 keywords;
+    guint32 comment;
+    guint32 working_dir;
+    guint32 try_exec;
+} CacheEntry;
+
+typedef struct {
+    guint32 trigram;
+    guint32 first_posting;
+    guint32 posting_count;
+} CacheTrigram;
+
+static const CacheDir *cache_dirs(const UIAppCache *cache) {
+    return (const CacheDir *)(cache->base + sizeof(CacheHeader));
+}
+
+static const CacheEntry *cache_entries(const UIAppCache *cache) {
+    return (const CacheEntry *)(cache->base + sizeof(CacheHeader) + cache->dir_count * sizeof(CacheDir));
+}
+
+static const CacheTrigram *cache_trigrams(const UIAppCache *cache) {
+    return (const CacheTrigram *)(cache_entries(cache) + cache->entry_count);
+}
+
+static const guint32 *cache_postings(const UIAppCache *cache) {
+    return (const guint32 *)(cache_trigrams(cache) + cache->trigram_count);
+}
+
+static const char *cache_string(const UIAppCache *cache, guint32 offset) {
+    if (offset == CACHE_NO_STRING || offset >= cache->strings_size)
+        return NULL;
+    const char *strings = (const char *)(cache_postings(cache) + cache->posting_count);
+    return strings + offset;
+}
+
+char *ui_app_cache_default_path(void) {
+    return g_build_filename(g_get_user_cache_dir(), "waycast", "catalog.bin", NULL);
+}
+
+void ui_app_cache_init(UIAppCache *cache) {
+    if (!cache)
+        return;
+    memset(cache, 0, sizeof(*cache));
+}
+
+gboolean ui_app_cache_open(UIAppCache *cache, const char *path) {
+    if (!cache || !path)
+        return FALSE;
+
+    ui_app_cache_close(cache);
+
+    GMappedFile *mapped = g_mapped_file_new(path, FALSE, NULL);
+    if (!mapped)
+        return FALSE;
+
+    gsize length = g_mapped_file_get_length(mapped);
+    const guint8 *base = (const guint8 *)g_mapped_file_get_contents(mapped);
+    if (!base || length < sizeof(CacheHeader)) {
+        g_mapped_file_unref(mapped);
+        return FALSE;
+    }
+
+    CacheHeader header;
+    memcpy(&header, base, sizeof(header));
+    gsize expected = sizeof(CacheHeader) +
+                     (gsize)header.dir_count * sizeof(CacheDir) +
+                     (gsize)header.entry_count * sizeof(CacheEntry) +
+                     (gsize)header.trigram_count * sizeof(CacheTrigram) +
+                     (gsize)header.posting_count * sizeof(guint32) +
+                     header.strings_size;
+
+    if (memcmp(header.magic, CACHE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != CACHE_VERSION ||
+        header.strings_size == 0 ||
+        expected != length ||
+        base[length - 1] != '\0') {
+        g_mapped_file_unref(mapped);
+        return FALSE;
+    }
+
+    cache->mapped = mapped;
+    cache->base = base;
+    cache->dir_count = header.dir_count;
+    cache->entry_count = header.entry_count;
+    cache->trigram_count = header.trigram_count;
+    cache->posting_count = header.posting_count;
+    cache->strings_size = header.strings_size;
+
+    const CacheDir *dirs = cache_dirs(cache);
+    for (guint32 i = 0; i < cache->dir_count; i++) {
+        if (dirs[i].first_entry > cache->entry_count ||
+            dirs[i].entry_count > cache->entry_count - dirs[i].first_entry ||
+            (dirs[i].parent != CACHE_NO_PARENT && dirs[i].parent >= i)) {
+            ui_app_cache_close(cache);
+            return FALSE;
+        }
+    }
+
+    const CacheTrigram *trigrams = cache_trigrams(cache);
+    for (guint32 i = 0; i < cache->trigram_count; i++) {
+        if (trigrams[i].first_posting > cache->posting_count ||
+            trigrams[i].posting_count > cache->posting_count - trigrams[i].first_posting ||
+            (i > 0 && trigrams[i].trigram <= trigrams[i - 1].trigram)) {
+            ui_app_cache_close(cache);
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+void ui_app_cache_close(UIAppCache *cache) {
+    if (!cache)
+        return;
+
+    g_clear_pointer(&cache->mapped, g_mapped_file_unref);
+    cache->base = NULL;
+    cache->dir_count = 0;
+    cache->entry_count = 0;
+    cache->trigram_count = 0;
+    cache->posting_count = 0;
+    cache->strings_size = 0;
+}
+
+guint ui_app_cache_dir_count(const UIAppCache *cache) {
+    if (!cache || !cache->mapped)
+        return 0;
+    return cache->dir_count;
+}
+
+gint ui_app_cache_find_dir(const UIAppCache *cache, const char *dir_path, gint64 *mtime) {
+    if (!cache || !cache->mapped || !dir_path)
+        return -1;
+
+    const CacheDir *dirs = cache_dirs(cache);
+    for (guint32 i = 0; i < cache->dir_count; i++) {
+        if (g_strcmp0(cache_string(cache, dirs[i].path), dir_path) == 0) {
+            if (mtime)
+                *mtime = dirs[i].mtime;
+            return (gint)i;
+        }
+    }
+    return -1;
+}
+
+gint ui_app_cache_dir_parent(const UIAppCache *cache, gint dir) {
+    if (!cache || !cache->mapped || dir < 0 || (guint32)dir >= cache->dir_count)
+        return -1;
+
+    guint32 parent = cache_dirs(cache)[dir].parent;
+    return parent == CACHE_NO_PARENT ? -1 : (gint)parent;
+}
+
+const char *ui_app_cache_dir_path(const UIAppCache *cache, gint dir) {
+    if (!cache || !cache->mapped || dir < 0 || (guint32)dir >= cache->dir_count)
+        return NULL;
+    return cache_string(cache, cache_dirs(cache)[dir].path);
+}
+
+guint ui_app_cache_dir_entry_count(const UIAppCache *cache, gint dir) {
+    if (!cache || !cache->mapped || dir < 0 || (guint32)dir >= cache->dir_count)
+        return 0;
+    return cache_dirs(cache)[dir].entry_count;
+}
+
+static void fill_entry(const UIAppCache *cache, const CacheEntry *raw, UIAppCacheEntry *entry) {
+    entry->mtime = raw->mtime;
+    entry->size = raw->size;
+    entry->flags = raw->flags;
+    entry->file = cache_string(cache, raw->file);
+    entry->name = cache_string(cache, raw->name);
+    entry->exec = cache_string(cache, raw->exec);
+    entry->icon = cache_string(cache, raw->icon);
+    entry->generic_name = cache_string(cache, raw->generic_name);
+    entry->keywords = cache_string(cache, raw->keywords);
+    entry->comment = cache_string(cache, raw->comment);
+    entry->working_dir = cache_string(cache, raw->working_dir);
+    entry->try_exec = cache_string(cache, raw->try_exec);
+}
+
+gboolean ui_app_cache_dir_entry(const UIAppCache *cache, gint dir, guint pos, UIAppCacheEntry *entry) {
+    if (!entry || pos >= ui_app_cache_dir_entry_count(cache, dir))
+        return FALSE;
+
+    const CacheEntry *raw = &cache_entries(cache)[cache_dirs(cache)[dir].first_entry + pos];
+    fill_entry(cache, raw, entry);
+    return entry->file != NULL;
+}
+
+guint ui_app_cache_entry_count(const UIAppCache *cache) {
+    if (!cache || !cache->mapped)
+        return 0;
+    return cache->entry_count;
+}
+
+const guint32 *ui_app_cache_postings(const UIAppCache *cache, guint32 trigram, guint *count) {
+    *count = 0;
+    if (!cache || !cache->mapped)
+        return NULL;
+
+    const CacheTrigram *trigrams = cache_trigrams(cache);
+    guint lo = 0;
+    guint hi = cache->trigram_count;
+    while (lo < hi) {
+        guint mid = lo + (hi - lo) / 2;
+        if (trigrams[mid].trigram == trigram) {
+            *count = trigrams[mid].posting_count;
+            return cache_postings(cache) + trigrams[mid].first_posting;
+        }
+        if (trigrams[mid].trigram < trigram)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return NULL;
+}
+
+gboolean ui_app_cache_lookup(const UIAppCache *cache, gint dir, const char *file, UIAppCacheEntry *entry) {
+    guint count = ui_app_cache_dir_entry_count(cache, dir);
+    if (count == 0 || !file || !entry)
+        return FALSE;
+
+    const CacheEntry *raw = &cache_entries(cache)[cache_dirs(cache)[dir].first_entry];
+    guint lo = 0;
+    guint hi = count;
+    while (lo < hi) {
+        guint mid = lo + (hi - lo) / 2;
+        const char *candidate = cache_string(cache, raw[mid].file);
+        int cmp = strcmp(candidate ? candidate : "", file);
+        if (cmp == 0) {
+            fill_entry(cache, &raw[mid], entry);
+            return TRUE;
+        }
+        if (cmp < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return FALSE;
+}
+
+static void free_postings(gpointer data) {
+    g_array_free((GArray *)data, TRUE);
+}
+
+void ui_app_cache_writer_init(UIAppCacheWriter *writer) {
+    if (!writer)
+        return;
+
+    writer->dirs = g_array_new(FALSE, TRUE, sizeof(CacheDir));
+    writer->entries = g_array_new(FALSE, TRUE, sizeof(CacheEntry));
+    writer->strings = g_string_new(NULL);
+    writer->interned = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+    writer->postings = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, free_postings);
+    writer->trigrams = g_array_new(FALSE, FALSE, sizeof(guint32));
+}
+
+void ui_app_cache_writer_clear(UIAppCacheWriter *writer) {
+    if (!writer)
+        return;
+
+    if (writer->dirs)
+        g_array_free(writer->dirs, TRUE);
+    if (writer->entries)
+        g_array_free(writer->entries, TRUE);
+    if (writer->strings)
+        g_string_free(writer->strings, TRUE);
+    g_clear_pointer(&writer->interned, g_hash_table_destroy);
+    g_clear_pointer(&writer->postings, g_hash_table_destroy);
+    if (writer->trigrams)
+        g_array_free(writer->trigrams, TRUE);
+    writer->trigrams = NULL;
+
+    writer->dirs = NULL;
+    writer->entries = NULL;
+    writer->strings = NULL;
+}
+
+static guint32 writer_intern(UIAppCacheWriter *writer, const char *text) {
+    if (!text)
+        return CACHE_NO_STRING;
+
+    gpointer existing;
+    if (g_hash_table_lookup_extended(writer->interned, text, NULL, &existing))
+        return GPOINTER_TO_UINT(existing);
+
+    guint32 offset = (guint32)writer->strings->len;
+    g_string_append_len(writer->strings, text, (gssize)strlen(text) + 1);
+    g_hash_table_insert(writer->interned, g_strdup(text), GUINT_TO_POINTER(offset));
+    return offset;
+}
+
+static void writer_index_field(UIAppCacheWriter *writer, const char *text) {
+    if (!text || !*text)
+        return;
+
+    gchar *folded = g_utf8_casefold(text, -1);
+    ui_fuzzy_trigrams(folded, writer->trigrams);
+    g_free(folded);
+}
+
+static void writer_index_entry(UIAppCacheWriter *writer, guint32 index, const UIAppCacheEntry *entry) {
+    g_array_set_size(writer->trigrams, 0);
+    writer_index_field(writer, entry->generic_name);
+    writer_index_field(writer, entry->keywords);
+    writer_index_field(writer, entry->comment);
+    ui_fuzzy_sort_unique(writer->trigrams);
+
+    for (guint i = 0; i < writer->trigrams->len; i++) {
+        gpointer key = GUINT_TO_POINTER(g_array_index(writer->trigrams, guint32, i));
+        GArray *postings = g_hash_table_lookup(writer->postings, key);
+        if (!postings) {
+            postings = g_array_new(FALSE, FALSE, sizeof(guint32));
+            g_hash_table_insert(writer->postings, key, postings);
+        }
+        g_array_append_val(postings, index);
+    }
+}
+
+gint ui_app_cache_writer_add_dir(UIAppCacheWriter *writer, const char *dir_path, gint parent, gint64 mtime) {
+    if (!writer || !writer->dirs || !dir_path)
+        return -1;
+
+    CacheDir dir = {
+        .mtime = mtime,
+        .path = writer_intern(writer, dir_path),
+        .parent = (parent >= 0 && (guint)parent < writer->dirs->len) ? (guint32)parent : CACHE_NO_PARENT,
+        .first_entry = writer->entries->len,
+        .entry_count = 0
+    };
+    g_array_append_val(writer->dirs, dir);
+    return (gint)writer->dirs->len - 1;
+}
+
+void ui_app_cache_writer_add_entry(UIAppCacheWriter *writer, const UIAppCacheEntry *entry) {
+    if (!writer || !writer->dirs || writer->dirs->len == 0 || !entry || !entry->file)
+        return;
+
+    CacheEntry raw = {
+        .mtime = entry->mtime,
+        .size = entry->size,
+        .file = writer_intern(writer, entry->file),
+        .flags = entry->flags,
+        .name = writer_intern(writer, entry->name),
+        .exec = writer_intern(writer, entry->exec),
+        .icon = writer_intern(writer, entry->icon),
+        .generic_name = writer_intern(writer, entry->generic_name),
+        .keywords = writer_intern(writer, entry->keywords),
+        .comment = writer_intern(writer, entry->comment),
+        .working_dir = writer_intern(writer, entry->working_dir),
+        .try_exec = writer_intern(writer, entry->try_exec)
+    };
+    if (entry->flags & UI_APP_CACHE_ENTRY_VISIBLE)
+        writer_index_entry(writer, writer->entries->len, entry);
+    g_array_append_val(writer->entries, raw);
+
+    CacheDir *dir = &g_array_index(writer->dirs, CacheDir, writer->dirs->len - 1);
+    dir->entry_count++;
+}
+
+gboolean ui_app_cache_writer_commit(UIAppCacheWriter *writer, const char *path) {
+    if (!writer || !writer->dirs || !path)
+        return FALSE;
+
+    if (writer->strings->len == 0)
+        g_string_append_c(writer->strings, '\0');
+
+    GArray *keys = g_array_sized_new(FALSE, FALSE, sizeof(guint32), g_hash_table_size(writer->postings));
+    GHashTableIter iter;
+    gpointer key;
+    g_hash_table_iter_init(&iter, writer->postings);
+    while (g_hash_table_iter_next(&iter, &key, NULL)) {
+        guint32 trigram = GPOINTER_TO_UINT(key);
+        g_array_append_val(keys, trigram);
+    }
+    ui_fuzzy_sort_unique(keys);
+
+    GArray *trigrams = g_array_sized_new(FALSE, FALSE, sizeof(CacheTrigram), keys->len);
+    GArray *postings = g_array_new(FALSE, FALSE, sizeof(guint32));
+    for (guint i = 0; i < keys->len; i++) {
+        guint32 trigram = g_array_index(keys, guint32, i);
+        GArray *list = g_hash_table_lookup(writer->postings, GUINT_TO_POINTER(trigram));
+        CacheTrigram raw = {
+            .trigram = trigram,
+            .first_posting = postings->len,
+            .posting_count = list->len
+        };
+        g_array_append_val(trigrams, raw);
+        g_array_append_vals(postings, list->data, list->len);
+    }
+    g_array_free(keys, TRUE);
+
+    CacheHeader header = {
+        .version = CACHE_VERSION,
+        .dir_count = writer->dirs->len,
+        .entry_count = writer->entries->len,
+        .trigram_count = trigrams->len,
+        .posting_count = postings->len,
+        .strings_size = (guint32)writer->strings->len
+    };
+    memcpy(header.magic, CACHE_MAGIC, sizeof(header.magic));
+
+    GByteArray *blob = g_byte_array_sized_new(sizeof(header) +
+                                              writer->dirs->len * sizeof(CacheDir) +
+                                              writer->entries->len * sizeof(CacheEntry) +
+                                              trigrams->len * sizeof(CacheTrigram) +
+                                              postings->len * sizeof(guint32) +
+                                              writer->strings->len);
+    g_byte_array_append(blob, (const guint8 *)&header, sizeof(header));
+    g_byte_array_append(blob, (const guint8 *)writer->dirs->data, writer->dirs->len * sizeof(CacheDir));
+    g_byte_array_append(blob, (const guint8 *)writer->entries->data, writer->entries->len * sizeof(CacheEntry));
+    g_byte_array_append(blob, (const guint8 *)trigrams->data, trigrams->len * sizeof(CacheTrigram));
+    g_byte_array_append(blob, (const guint8 *)postings->data, postings->len * sizeof(guint32));
+    g_byte_array_append(blob, (const guint8 *)writer->strings->str, (guint)writer->strings->len);
+    g_array_free(postings, TRUE);
+    g_array_free(trigrams, TRUE);
+
+    gchar *dir_path = g_path_get_dirname(path);
+    g_mkdir_with_parents(dir_path, 0700);
+    g_free(dir_path);
+
+    gboolean ok = g_file_set_contents(path, (const gchar *)blob->data, blob->len, NULL);
+    g_byte_array_free(blob, TRUE);
+    return ok;
+}
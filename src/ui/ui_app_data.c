@@ -1,17 +1,27 @@
+#define _GNU_SOURCE
 #include "ui/ui_app_data.h"
+#include "Trace.h"
+#include "ui/ui_app_cache.h"
+#include "ui/ui_app_exec.h"
+#include "ui/ui_app_watch.h"
+#include "ui/ui_fuzzy.h"
+#include <glib/gstdio.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
 
-static void free_app(gpointer data) {
-    App *app = (App *)data;
-    if (!app)
+#define APP_STRING_CHUNK_SIZE 16384
+#define APP_NOT_INDEXED G_MAXUINT32
+#define RESULT_STRING_CHUNK_SIZE 8192
+
+static void free_app_dir(gpointer data) {
+    UIAppDir *dir = (UIAppDir *)data;
+    if (!dir)
         return;
 
-    g_free(app->name);
-    g_free(app->exec);
-    g_free(app->icon);
-    g_free(app);
+    g_free(dir->path);
+    g_free(dir->id_prefix);
+    g_free(dir);
 }
 
 static gchar *casefold_text(const gchar *text) {
@@ -24,8 +34,30 @@ void ui_app_data_init(UIAppData *data) {
     if (!data)
         return;
 
-    data->apps = g_ptr_array_new_with_free_func(free_app);
+    data->strings = g_string_chunk_new(APP_STRING_CHUNK_SIZE);
+    data->apps = g_array_new(FALSE, FALSE, sizeof(App));
+    data->dirs = g_ptr_array_new_with_free_func(free_app_dir);
+    data->search_keys = g_string_new(NULL);
+    data->search_offsets = g_array_new(FALSE, FALSE, sizeof(guint32));
+    data->search_masks = g_array_new(FALSE, FALSE, sizeof(guint64));
+    data->field_keys = g_array_new(FALSE, FALSE, sizeof(UIAppFieldKeys));
+    data->frecency = g_array_new(FALSE, FALSE, sizeof(guint));
+    data->app_entries = g_array_new(FALSE, FALSE, sizeof(guint32));
+    data->entry_apps = g_array_new(FALSE, FALSE, sizeof(guint32));
+    ui_app_cache_init(&data->index);
+    data->unindexed = 0;
     data->filtered_indices = g_array_new(FALSE, FALSE, sizeof(guint));
+    data->result_strings = g_string_chunk_new(RESULT_STRING_CHUNK_SIZE);
+    data->result_apps = g_array_new(FALSE, FALSE, sizeof(App));
+    ui_file_db_init(&data->files);
+    ui_path_index_init(&data->commands);
+    ui_line_store_init(&data->lines);
+    ui_app_search_init(&data->search);
+    data->dead_keys = 0;
+    data->revision = 0;
+    data->files_revision = 0;
+    data->commands_revision = 0;
+    data->generation = 0;
 }
 
 void ui_app_data_free(UIAppData *data) {
@@ -33,100 +65,1266 @@ void ui_app_data_free(UIAppData *data) {
         return;
 
     if (data->apps)
-        g_ptr_array_free(data->apps, TRUE);
+        g_array_free(data->apps, TRUE);
+    if (data->dirs)
+        g_ptr_array_free(data->dirs, TRUE);
+    if (data->search_keys)
+        g_string_free(data->search_keys, TRUE);
+    if (data->search_offsets)
+        g_array_free(data->search_offsets, TRUE);
+    if (data->search_masks)
+        g_array_free(data->search_masks, TRUE);
+    if (data->field_keys)
+        g_array_free(data->field_keys, TRUE);
+    if (data->frecency)
+        g_array_free(data->frecency, TRUE);
+    if (data->app_entries)
+        g_array_free(data->app_entries, TRUE);
+    if (data->entry_apps)
+        g_array_free(data->entry_apps, TRUE);
     if (data->filtered_indices)
         g_array_free(data->filtered_indices, TRUE);
+    if (data->result_apps)
+        g_array_free(data->result_apps, TRUE);
 
+    ui_file_db_close(&data->files);
+    ui_path_index_close(&data->commands);
+    ui_line_store_clear(&data->lines);
+    g_clear_pointer(&data->result_strings, g_string_chunk_free);
+    ui_app_search_clear(&data->search);
+    ui_app_cache_close(&data->index);
+    g_clear_pointer(&data->strings, g_string_chunk_free);
     data->apps = NULL;
+    data->dirs = NULL;
+    data->search_keys = NULL;
+    data->search_offsets = NULL;
+    data->search_masks = NULL;
+    data->field_keys = NULL;
+    data->frecency = NULL;
+    data->app_entries = NULL;
+    data->entry_apps = NULL;
     data->filtered_indices = NULL;
+    data->result_apps = NULL;
 }
 
-void ui_app_data_load(UIAppData *data) {
-    if (!data || !data->apps)
+#define LOAD_MAX_DIR_DEPTH 8
+#define LOAD_PARALLEL_THRESHOLD 32
+
+typedef struct {
+    char *path;
+    char *id;
+    gint dir;
+    gboolean owned;
+    UIAppCacheEntry entry;
+} LoadedFile;
+
+typedef struct {
+    char *path;
+    char *id_prefix;
+    gint parent;
+    gint64 mtime;
+} ScannedDir;
+
+typedef struct {
+    UIAppCache cache;
+    GArray *dirs;
+    GPtrArray *files;
+    GPtrArray *pending;
+    GHashTable *visited;
+    int watch_fd;
+    gboolean stale;
+} LoadScan;
+
+static gboolean stat_stamp(const char *path, gboolean want_dir, gint64 *mtime, gint64 *size) {
+    GStatBuf st;
+    if (g_stat(path, &st) != 0)
+        return FALSE;
+    if (want_dir ? !S_ISDIR(st.st_mode) : !S_ISREG(st.st_mode))
+        return FALSE;
+
+    if (mtime)
+        *mtime = (gint64)st.st_mtim.tv_sec * G_GINT64_CONSTANT(1000000000) + st.st_mtim.tv_nsec;
+    if (size)
+        *size = (gint64)st.st_size;
+    return TRUE;
+}
+
+static gint compare_file_names(gconstpointer a, gconstpointer b) {
+    return strcmp(*(const char *const *)a, *(const char *const *)b);
+}
+
+static void list_dir(const char *dir_path, GPtrArray *files, GPtrArray *subdirs) {
+    GDir *dir = g_dir_open(dir_path, 0, NULL);
+    if (!dir)
+        return;
+
+    const gchar *entry_name;
+    while ((entry_name = g_dir_read_name(dir)) != NULL) {
+        if (g_str_has_suffix(entry_name, ".desktop")) {
+            g_ptr_array_add(files, g_strdup(entry_name));
+            continue;
+        }
+
+        gchar *full_path = g_build_filename(dir_path, entry_name, NULL);
+        if (g_file_test(full_path, G_FILE_TEST_IS_DIR))
+            g_ptr_array_add(subdirs, g_strdup(entry_name));
+        g_free(full_path);
+    }
+    g_dir_close(dir);
+
+    g_ptr_array_sort(files, compare_file_names);
+    g_ptr_array_sort(subdirs, compare_file_names);
+}
+
+static void list_cached_dir(const UIAppCache *cache, gint cached_dir, GPtrArray *files, GPtrArray *subdirs) {
+    guint count = ui_app_cache_dir_entry_count(cache, cached_dir);
+    for (guint i = 0; i < count; i++) {
+        UIAppCacheEntry entry;
+        if (ui_app_cache_dir_entry(cache, cached_dir, i, &entry))
+            g_ptr_array_add(files, g_strdup(entry.file));
+    }
+
+    guint dir_count = ui_app_cache_dir_count(cache);
+    for (guint i = (guint)cached_dir + 1; i < dir_count; i++) {
+        if (ui_app_cache_dir_parent(cache, (gint)i) == cached_dir)
+            g_ptr_array_add(subdirs, g_path_get_basename(ui_app_cache_dir_path(cache, (gint)i)));
+    }
+    g_ptr_array_sort(subdirs, compare_file_names);
+}
+
+static void parse_desktop_file(const char *path, UIAppCacheEntry *entry) {
+    GKeyFile *file = g_key_file_new();
+    if (g_key_file_load_from_file(file, path, G_KEY_FILE_NONE, NULL) &&
+        g_key_file_has_group(file, "Desktop Entry")) {
+        entry->flags |= UI_APP_CACHE_ENTRY_PARSED;
+
+        gchar *type = g_key_file_get_string(file, "Desktop Entry", "Type", NULL);
+        gboolean shown = g_strcmp0(type, "Application") == 0 &&
+                         !g_key_file_get_boolean(file, "Desktop Entry", "NoDisplay", NULL) &&
+                         !g_key_file_get_boolean(file, "Desktop Entry", "Hidden", NULL);
+        g_free(type);
+
+        entry->name = g_key_file_get_string(file, "Desktop Entry", "Name", NULL);
+        entry->icon = g_key_file_get_string(file, "Desktop Entry", "Icon", NULL);
+        gchar *exec = g_key_file_get_string(file, "Desktop Entry", "Exec", NULL);
+        entry->exec = ui_app_exec_compile(exec, entry->name, entry->icon, path);
+        g_free(exec);
+        entry->working_dir = g_key_file_get_string(file, "Desktop Entry", "Path", NULL);
+        entry->try_exec = g_key_file_get_string(file, "Desktop Entry", "TryExec", NULL);
+        if (g_key_file_get_boolean(file, "Desktop Entry", "Terminal", NULL))
+            entry->flags |= UI_APP_CACHE_ENTRY_TERMINAL;
+        entry->generic_name = g_key_file_get_string(file, "Desktop Entry", "GenericName", NULL);
+        entry->keywords = g_key_file_get_string(file, "Desktop Entry", "Keywords", NULL);
+        entry->comment = g_key_file_get_string(file, "Desktop Entry", "Comment", NULL);
+        if (shown && entry->name && entry->exec)
+            entry->flags |= UI_APP_CACHE_ENTRY_VISIBLE;
+    }
+    g_key_file_free(file);
+}
+
+static void free_entry_strings(UIAppCacheEntry *entry) {
+    g_free((gpointer)entry->name);
+    g_free((gpointer)entry->exec);
+    g_free((gpointer)entry->icon);
+    g_free((gpointer)entry->generic_name);
+    g_free((gpointer)entry->keywords);
+    g_free((gpointer)entry->comment);
+    g_free((gpointer)entry->working_dir);
+    g_free((gpointer)entry->try_exec);
+}
+
+static void free_loaded_file(gpointer data) {
+    LoadedFile *loaded = (LoadedFile *)data;
+    if (!loaded)
+        return;
+
+    if (loaded->owned)
+        free_entry_strings(&loaded->entry);
+    g_free((gpointer)loaded->entry.file);
+    g_free(loaded->path);
+    g_free(loaded->id);
+    g_free(loaded);
+}
+
+static gboolean entry_launchable(const UIPathIndex *commands, const UIAppCacheEntry *entry) {
+    return (entry->flags & UI_APP_CACHE_ENTRY_VISIBLE) && ui_app_exec_available(commands, entry->try_exec);
+}
+
+static const char *intern_string(UIAppData *data, const char *text) {
+    return text ? g_string_chunk_insert_const(data->strings, text) : NULL;
+}
+
+static App new_app(UIAppData *data, const char *id, const char *path, const UIAppCacheEntry *entry) {
+    return (App){
+        .id = g_string_chunk_insert(data->strings, id),
+        .name = intern_string(data, entry->name),
+        .exec = intern_string(data, entry->exec),
+        .icon = intern_string(data, entry->icon),
+        .path = g_string_chunk_insert(data->strings, path),
+        .working_dir = intern_string(data, entry->working_dir),
+        .terminal = (entry->flags & UI_APP_CACHE_ENTRY_TERMINAL) != 0
+    };
+}
+
+static const char *search_key(const UIAppData *data, guint index) {
+    return data->search_keys->str + g_array_index(data->search_offsets, guint32, index);
+}
+
+static guint32 add_search_key(UIAppData *data, const char *name) {
+    guint32 offset = (guint32)data->search_keys->len;
+    gchar *folded = casefold_text(name);
+    g_string_append_len(data->search_keys, folded ? folded : "", folded ? (gssize)strlen(folded) + 1 : 1);
+    g_free(folded);
+    return offset;
+}
+
+static const char *field_key(const UIAppData *data, guint index, UIAppField field) {
+    return data->search_keys->str + g_array_index(data->field_keys, UIAppFieldKeys, index).offsets[field];
+}
+
+static UIAppFieldKeys add_field_keys(UIAppData *data, const UIAppCacheEntry *entry) {
+    UIAppFieldKeys keys = {
+        .offsets = {
+            [UI_APP_FIELD_GENERIC_NAME] = add_search_key(data, entry->generic_name),
+            [UI_APP_FIELD_KEYWORDS] = add_search_key(data, entry->keywords),
+            [UI_APP_FIELD_COMMENT] = add_search_key(data, entry->comment)
+        }
+    };
+    return keys;
+}
+
+static void retire_keys(UIAppData *data, guint index) {
+    data->dead_keys += strlen(search_key(data, index)) + 1;
+    for (guint field = 0; field < UI_APP_FIELD_COUNT; field++)
+        data->dead_keys += strlen(field_key(data, index, (UIAppField)field)) + 1;
+}
+
+static guint32 copy_key(GString *keys, const char *key) {
+    guint32 offset = (guint32)keys->len;
+    g_string_append_len(keys, key, (gssize)strlen(key) + 1);
+    return offset;
+}
+
+static void compact_apps(UIAppData *data) {
+    if (data->dead_keys * 2 <= data->search_keys->len)
+        return;
+
+    GString *keys = g_string_sized_new(data->search_keys->len - data->dead_keys);
+    GStringChunk *old_strings = data->strings;
+    data->strings = g_string_chunk_new(APP_STRING_CHUNK_SIZE);
+    for (guint i = 0; i < data->apps->len; i++) {
+        App *app = &g_array_index(data->apps, App, i);
+        app->id = g_string_chunk_insert(data->strings, app->id);
+        app->name = intern_string(data, app->name);
+        app->exec = intern_string(data, app->exec);
+        app->icon = intern_string(data, app->icon);
+        app->path = g_string_chunk_insert(data->strings, app->path);
+        app->working_dir = intern_string(data, app->working_dir);
+
+        guint32 *offset = &g_array_index(data->search_offsets, guint32, i);
+        *offset = copy_key(keys, data->search_keys->str + *offset);
+        UIAppFieldKeys *fields = &g_array_index(data->field_keys, UIAppFieldKeys, i);
+        for (guint field = 0; field < UI_APP_FIELD_COUNT; field++)
+            fields->offsets[field] = copy_key(keys, data->search_keys->str + fields->offsets[field]);
+    }
+
+    g_string_free(data->search_keys, TRUE);
+    data->search_keys = keys;
+    g_string_chunk_free(old_strings);
+    data->dead_keys = 0;
+}
+
+static void unindex_app(UIAppData *data, guint index) {
+    guint32 *entry = &g_array_index(data->app_entries, guint32, index);
+    if (*entry == APP_NOT_INDEXED)
+        return;
+
+    g_array_index(data->entry_apps, guint32, *entry) = APP_NOT_INDEXED;
+    *entry = APP_NOT_INDEXED;
+    data->unindexed++;
+}
+
+static void append_app(UIAppData *data, const char *id, const char *path, const UIAppCacheEntry *entry, guint32 cache_entry) {
+    App app = new_app(data, id, path, entry);
+    guint32 offset = add_search_key(data, entry->name);
+    guint64 mask = ui_fuzzy_char_mask(data->search_keys->str + offset);
+    UIAppFieldKeys keys = add_field_keys(data, entry);
+    guint frecency = 0;
+    guint32 index = data->apps->len;
+
+    g_array_append_val(data->apps, app);
+    g_array_append_val(data->search_offsets, offset);
+    g_array_append_val(data->search_masks, mask);
+    g_array_append_val(data->field_keys, keys);
+    g_array_append_val(data->frecency, frecency);
+    g_array_append_val(data->app_entries, cache_entry);
+
+    if (cache_entry < data->entry_apps->len)
+        g_array_index(data->entry_apps, guint32, cache_entry) = index;
+    else
+        data->unindexed++;
+}
+
+static void replace_app(UIAppData *data, guint index, const char *id, const char *path, const UIAppCacheEntry *entry) {
+    retire_keys(data, index);
+    guint32 offset = add_search_key(data, entry->name);
+    g_array_index(data->apps, App, index) = new_app(data, id, path, entry);
+    g_array_index(data->search_offsets, guint32, index) = offset;
+    g_array_index(data->search_masks, guint64, index) = ui_fuzzy_char_mask(data->search_keys->str + offset);
+    g_array_index(data->field_keys, UIAppFieldKeys, index) = add_field_keys(data, entry);
+    unindex_app(data, index);
+}
+
+static void remove_app(UIAppData *data, guint index) {
+    retire_keys(data, index);
+    guint32 entry = g_array_index(data->app_entries, guint32, index);
+    if (entry == APP_NOT_INDEXED)
+        data->unindexed--;
+    else
+        g_array_index(data->entry_apps, guint32, entry) = APP_NOT_INDEXED;
+
+    guint32 *entry_apps = (guint32 *)(void *)data->entry_apps->data;
+    for (guint i = 0; i < data->entry_apps->len; i++) {
+        if (entry_apps[i] != APP_NOT_INDEXED && entry_apps[i] > index)
+            entry_apps[i]--;
+    }
+
+    for (guint i = data->filtered_indices->len; i > 0; i--) {
+        guint *filtered = &g_array_index(data->filtered_indices, guint, i - 1);
+        if ((*filtered & UI_APP_RESULT_EXTERNAL) || *filtered < index)
+            continue;
+        if (*filtered == index)
+            g_array_remove_index(data->filtered_indices, i - 1);
+        else
+            (*filtered)--;
+    }
+
+    g_array_remove_index(data->apps, index);
+    g_array_remove_index(data->search_offsets, index);
+    g_array_remove_index(data->search_masks, index);
+    g_array_remove_index(data->field_keys, index);
+    g_array_remove_index(data->frecency, index);
+    g_array_remove_index(data->app_entries, index);
+}
+
+static void drop_index(UIAppData *data) {
+    ui_app_cache_close(&data->index);
+    g_array_set_size(data->entry_apps, 0);
+    if (data->app_entries->len > 0)
+        memset(data->app_entries->data, 0xff, data->app_entries->len * sizeof(guint32));
+    data->unindexed = data->apps->len;
+}
+
+static void clear_apps(UIAppData *data) {
+    g_array_set_size(data->apps, 0);
+    g_string_truncate(data->search_keys, 0);
+    data->dead_keys = 0;
+    g_array_set_size(data->search_offsets, 0);
+    g_array_set_size(data->search_masks, 0);
+    g_array_set_size(data->field_keys, 0);
+    g_array_set_size(data->frecency, 0);
+    g_array_set_size(data->app_entries, 0);
+    g_array_set_size(data->entry_apps, 0);
+    ui_app_cache_close(&data->index);
+    data->unindexed = 0;
+    g_string_chunk_clear(data->strings);
+}
+
+static void add_search_dir(GPtrArray *dirs, const char *data_dir) {
+    if (!data_dir || !g_path_is_absolute(data_dir))
         return;
 
-    g_ptr_array_set_size(data->apps, 0);
+    gchar *path = g_build_filename(data_dir, "applications", NULL);
+    for (guint i = 0; i < dirs->len; i++) {
+        if (strcmp(g_ptr_array_index(dirs, i), path) == 0) {
+            g_free(path);
+            return;
+        }
+    }
+    g_ptr_array_add(dirs, path);
+}
+
+GPtrArray *ui_app_data_directories(void) {
+    GPtrArray *dirs = g_ptr_array_new_with_free_func(g_free);
+    add_search_dir(dirs, g_get_user_data_dir());
+
+    const gchar *const *system_dirs = g_get_system_data_dirs();
+    for (guint i = 0; system_dirs && system_dirs[i]; i++)
+        add_search_dir(dirs, system_dirs[i]);
+    return dirs;
+}
 
-    const char *dirs[] = {
-        "/usr/share/applications",
-        g_build_filename(g_get_home_dir(), ".local", "share", "applications", NULL)
+static void scan_dir(LoadScan *scan, const char *dir_path, const char *id_prefix, gint parent, guint depth) {
+    gint64 dir_mtime = 0;
+    if (depth > LOAD_MAX_DIR_DEPTH)
+        return;
+
+    ui_app_watch_add_dir(scan->watch_fd, dir_path);
+    if (!stat_stamp(dir_path, TRUE, &dir_mtime, NULL))
+        return;
+
+    gchar *real_path = realpath(dir_path, NULL);
+    if (!real_path || !g_hash_table_add(scan->visited, real_path))
+        return;
+
+    gint index = (gint)scan->dirs->len;
+    ScannedDir scanned = {
+        .path = g_strdup(dir_path),
+        .id_prefix = g_strdup(id_prefix),
+        .parent = parent,
+        .mtime = dir_mtime
     };
+    g_array_append_val(scan->dirs, scanned);
+
+    gint64 cached_mtime = 0;
+    gint cached_dir = ui_app_cache_find_dir(&scan->cache, dir_path, &cached_mtime);
+    if (cached_dir != index || ui_app_cache_dir_parent(&scan->cache, cached_dir) != parent)
+        scan->stale = TRUE;
+
+    GPtrArray *files = g_ptr_array_new_with_free_func(g_free);
+    GPtrArray *subdirs = g_ptr_array_new_with_free_func(g_free);
+    if (cached_dir >= 0 && cached_mtime == dir_mtime) {
+        list_cached_dir(&scan->cache, cached_dir, files, subdirs);
+    } else {
+        list_dir(dir_path, files, subdirs);
+        scan->stale = TRUE;
+    }
+
+    for (guint i = 0; i < files->len; i++) {
+        const char *file_name = g_ptr_array_index(files, i);
+        LoadedFile *loaded = g_new0(LoadedFile, 1);
+        loaded->path = g_build_filename(dir_path, file_name, NULL);
+        loaded->id = g_strconcat(id_prefix, file_name, NULL);
+        loaded->dir = index;
 
-    for (guint i = 0; i < G_N_ELEMENTS(dirs); i++) {
-        const char *dir_path = dirs[i];
-        if (!dir_path || !g_file_test(dir_path, G_FILE_TEST_IS_DIR)) {
-            if (i == 1)
-                g_free((gpointer)dir_path);
+        gint64 mtime = 0;
+        gint64 size = 0;
+        if (!stat_stamp(loaded->path, FALSE, &mtime, &size)) {
+            scan->stale = TRUE;
+            free_loaded_file(loaded);
             continue;
         }
 
-        GDir *dir = g_dir_open(dir_path, 0, NULL);
-        if (!dir) {
-            if (i == 1)
-                g_free((gpointer)dir_path);
+        if (!ui_app_cache_lookup(&scan->cache, cached_dir, file_name, &loaded->entry) ||
+            loaded->entry.mtime != mtime || loaded->entry.size != size) {
+            loaded->entry = (UIAppCacheEntry){.mtime = mtime, .size = size};
+            loaded->owned = TRUE;
+            g_ptr_array_add(scan->pending, loaded);
+            scan->stale = TRUE;
+        }
+        loaded->entry.file = g_strdup(file_name);
+        g_ptr_array_add(scan->files, loaded);
+    }
+
+    for (guint i = 0; i < subdirs->len; i++) {
+        const char *name = g_ptr_array_index(subdirs, i);
+        gchar *sub_path = g_build_filename(dir_path, name, NULL);
+        gchar *sub_prefix = g_strconcat(id_prefix, name, "-", NULL);
+        scan_dir(scan, sub_path, sub_prefix, index, depth + 1);
+        g_free(sub_prefix);
+        g_free(sub_path);
+    }
+
+    g_ptr_array_free(subdirs, TRUE);
+    g_ptr_array_free(files, TRUE);
+}
+
+static void parse_loaded_file(gpointer data, gpointer user_data) {
+    (void)user_data;
+    LoadedFile *loaded = (LoadedFile *)data;
+    parse_desktop_file(loaded->path, &loaded->entry);
+}
+
+static void parse_pending(GPtrArray *pending) {
+    guint workers = MIN(g_get_num_processors(), pending->len / (LOAD_PARALLEL_THRESHOLD / 2));
+    GThreadPool *pool = NULL;
+    if (pending->len >= LOAD_PARALLEL_THRESHOLD && workers > 1)
+        pool = g_thread_pool_new(parse_loaded_file, NULL, (gint)workers, FALSE, NULL);
+
+    for (guint i = 0; i < pending->len; i++) {
+        if (!pool || !g_thread_pool_push(pool, g_ptr_array_index(pending, i), NULL))
+            parse_loaded_file(g_ptr_array_index(pending, i), NULL);
+    }
+
+    if (pool)
+        g_thread_pool_free(pool, FALSE, TRUE);
+}
+
+struct UIAppLoad {
+    GArray *dirs;
+    GPtrArray *files;
+    UIAppCache source;
+    UIAppCache index;
+    UIPathIndex commands;
+    GHashTable *claimed;
+    guint next_file;
+    gboolean started;
+};
+
+static void write_cache(const LoadScan *scan, const char *cache_path, UIAppCache *index) {
+    UIAppCacheWriter writer;
+    ui_app_cache_writer_init(&writer);
+
+    guint next_file = 0;
+    for (guint d = 0; d < scan->dirs->len; d++) {
+        const ScannedDir *dir = &g_array_index(scan->dirs, ScannedDir, d);
+        ui_app_cache_writer_add_dir(&writer, dir->path, dir->parent, dir->mtime);
+        for (; next_file < scan->files->len; next_file++) {
+            const LoadedFile *loaded = g_ptr_array_index(scan->files, next_file);
+            if (loaded->dir != (gint)d)
+                break;
+            ui_app_cache_writer_add_entry(&writer, &loaded->entry);
+        }
+    }
+
+    if (ui_app_cache_writer_commit(&writer, cache_path))
+        ui_app_cache_open(index, cache_path);
+    ui_app_cache_writer_clear(&writer);
+}
+
+UIAppLoad *ui_app_load_new(int watch_fd) {
+    TRACE_SCOPE("ui_app_load_new");
+
+    LoadScan scan = {
+        .dirs = g_array_new(FALSE, FALSE, sizeof(ScannedDir)),
+        .files = g_ptr_array_new_with_free_func(free_loaded_file),
+        .pending = g_ptr_array_new(),
+        .visited = g_hash_table_new_full(g_str_hash, g_str_equal, free, NULL),
+        .watch_fd = watch_fd
+    };
+    ui_app_cache_init(&scan.cache);
+
+    gchar *cache_path = ui_app_cache_default_path();
+    scan.stale = !ui_app_cache_open(&scan.cache, cache_path);
+
+    TraceSpan scan_span = trace_span_begin("catalog_scan");
+    GPtrArray *roots = ui_app_data_directories();
+    for (guint i = 0; i < roots->len; i++)
+        scan_dir(&scan, g_ptr_array_index(roots, i), "", -1, 0);
+    g_ptr_array_free(roots, TRUE);
+    trace_span_end(&scan_span);
+
+    if (scan.dirs->len != ui_app_cache_dir_count(&scan.cache))
+        scan.stale = TRUE;
+
+    TraceSpan parse_span = trace_span_begin("catalog_parse");
+    parse_pending(scan.pending);
+    trace_span_end(&parse_span);
+
+    UIAppLoad *load = g_new0(UIAppLoad, 1);
+    ui_path_index_init(&load->commands);
+    ui_path_index_load(&load->commands);
+    ui_app_cache_init(&load->source);
+    ui_app_cache_init(&load->index);
+    if (scan.stale) {
+        write_cache(&scan, cache_path, &load->index);
+        load->source = scan.cache;
+    } else {
+        load->index = scan.cache;
+    }
+    load->dirs = scan.dirs;
+    load->files = scan.files;
+    load->claimed = g_hash_table_new(g_str_hash, g_str_equal);
+
+    g_hash_table_destroy(scan.visited);
+    g_ptr_array_free(scan.pending, TRUE);
+    g_free(cache_path);
+    return load;
+}
+
+static void load_begin(UIAppLoad *load, UIAppData *data) {
+    clear_apps(data);
+    g_ptr_array_set_size(data->dirs, 0);
+
+    for (guint d = 0; d < load->dirs->len; d++) {
+        ScannedDir *dir = &g_array_index(load->dirs, ScannedDir, d);
+        UIAppDir *app_dir = g_new0(UIAppDir, 1);
+        app_dir->path = g_steal_pointer(&dir->path);
+        app_dir->id_prefix = g_steal_pointer(&dir->id_prefix);
+        g_ptr_array_add(data->dirs, app_dir);
+    }
+
+    data->index = load->index;
+    ui_app_cache_init(&load->index);
+    ui_path_index_close(&data->commands);
+    data->commands = load->commands;
+    ui_path_index_init(&load->commands);
+    g_array_set_size(data->entry_apps, load->files->len);
+    if (load->files->len > 0)
+        memset(data->entry_apps->data, 0xff, load->files->len * sizeof(guint32));
+    if (ui_app_cache_entry_count(&data->index) != load->files->len)
+        drop_index(data);
+}
+
+gboolean ui_app_load_next(UIAppLoad *load, UIAppData *data, guint max_apps) {
+    if (!load || !data || !data->apps)
+        return FALSE;
+
+    if (!load->started) {
+        load_begin(load, data);
+        load->started = TRUE;
+    }
+
+    guint added = 0;
+    for (; load->next_file < load->files->len && added < max_apps; load->next_file++) {
+        LoadedFile *loaded = g_ptr_array_index(load->files, load->next_file);
+        if (!(loaded->entry.flags & UI_APP_CACHE_ENTRY_PARSED) ||
+            !g_hash_table_add(load->claimed, loaded->id) ||
+            !entry_launchable(&data->commands, &loaded->entry))
             continue;
+
+        guint32 cache_entry = load->next_file < data->entry_apps->len ? load->next_file : APP_NOT_INDEXED;
+        append_app(data, loaded->id, loaded->path, &loaded->entry, cache_entry);
+        added++;
+    }
+
+    data->revision++;
+    data->generation++;
+    return load->next_file < load->files->len;
+}
+
+void ui_app_load_free(UIAppLoad *load) {
+    if (!load)
+        return;
+
+    for (guint d = 0; d < load->dirs->len; d++) {
+        ScannedDir *dir = &g_array_index(load->dirs, ScannedDir, d);
+        g_free(dir->path);
+        g_free(dir->id_prefix);
+    }
+    g_array_free(load->dirs, TRUE);
+    g_hash_table_destroy(load->claimed);
+    g_ptr_array_free(load->files, TRUE);
+    ui_app_cache_close(&load->index);
+    ui_app_cache_close(&load->source);
+    ui_path_index_close(&load->commands);
+    g_free(load);
+}
+
+void ui_app_data_load(UIAppData *data) {
+    if (!data || !data->apps)
+        return;
+
+    TRACE_SCOPE("ui_app_data_load");
+
+    UIAppLoad *load = ui_app_load_new(-1);
+    while (ui_app_load_next(load, data, G_MAXUINT))
+        ;
+    ui_app_load_free(load);
+}
+
+static gint find_app_by_id(const UIAppData *data, const char *id) {
+    for (guint i = 0; i < data->apps->len; i++) {
+        if (g_strcmp0(g_array_index(data->apps, App, i).id, id) == 0)
+            return (gint)i;
+    }
+    return -1;
+}
+
+static gchar *desktop_id_for_path(const UIAppData *data, const char *path) {
+    gchar *dir_path = g_path_get_dirname(path);
+    gchar *id = NULL;
+    for (guint i = 0; i < data->dirs->len && !id; i++) {
+        const UIAppDir *dir = g_ptr_array_index(data->dirs, i);
+        if (strcmp(dir->path, dir_path) == 0) {
+            gchar *file_name = g_path_get_basename(path);
+            id = g_strconcat(dir->id_prefix, file_name, NULL);
+            g_free(file_name);
         }
+    }
+    g_free(dir_path);
+    return id;
+}
+
+static gint root_rank(const GPtrArray *roots, const char *path) {
+    for (guint i = 0; i < roots->len; i++) {
+        const char *root = g_ptr_array_index(roots, i);
+        gsize length = strlen(root);
+        if (strncmp(path, root, length) == 0 && (path[length] == '\0' || path[length] == '/'))
+            return (gint)i;
+    }
+    return -1;
+}
+
+gboolean ui_app_data_add_dir(UIAppData *data, const char *path) {
+    if (!data || !data->dirs || !path)
+        return FALSE;
 
-        const gchar *entry_name;
-        while ((entry_name = g_dir_read_name(dir)) != NULL) {
-            if (!g_str_has_suffix(entry_name, ".desktop"))
-                continue;
-
-            gchar *full_path = g_build_filename(dir_path, entry_name, NULL);
-            GKeyFile *file = g_key_file_new();
-            if (g_key_file_load_from_file(file, full_path, G_KEY_FILE_NONE, NULL)) {
-                gchar *name = g_key_file_get_string(file, "Desktop Entry", "Name", NULL);
-                gchar *exec = g_key_file_get_string(file, "Desktop Entry", "Exec", NULL);
-                gchar *icon = g_key_file_get_string(file, "Desktop Entry", "Icon", NULL);
-
-                if (name && exec) {
-                    App *app = g_new0(App, 1);
-                    app->name = name;
-                    app->exec = exec;
-                    app->icon = icon;
-                    g_ptr_array_add(data->apps, app);
-                } else {
-                    g_free(name);
-                    g_free(exec);
-                    g_free(icon);
-                }
+    for (guint i = 0; i < data->dirs->len; i++) {
+        const UIAppDir *dir = g_ptr_array_index(data->dirs, i);
+        if (strcmp(dir->path, path) == 0)
+            return TRUE;
+    }
+
+    GPtrArray *roots = ui_app_data_directories();
+    gint rank = root_rank(roots, path);
+    gchar *prefix = NULL;
+    guint position = data->dirs->len;
+    if (rank >= 0 && strcmp(path, g_ptr_array_index(roots, rank)) == 0) {
+        prefix = g_strdup("");
+        for (guint i = 0; i < data->dirs->len && position == data->dirs->len; i++) {
+            const UIAppDir *dir = g_ptr_array_index(data->dirs, i);
+            if (root_rank(roots, dir->path) > rank)
+                position = i;
+        }
+    } else if (rank >= 0) {
+        gchar *parent_path = g_path_get_dirname(path);
+        for (guint i = 0; i < data->dirs->len && !prefix; i++) {
+            const UIAppDir *dir = g_ptr_array_index(data->dirs, i);
+            if (strcmp(dir->path, parent_path) == 0) {
+                gchar *name = g_path_get_basename(path);
+                prefix = g_strconcat(dir->id_prefix, name, "-", NULL);
+                position = i + 1;
+                g_free(name);
             }
-            g_key_file_free(file);
-            g_free(full_path);
         }
+        g_free(parent_path);
+    }
+    g_ptr_array_free(roots, TRUE);
 
-        g_dir_close(dir);
-        if (i == 1)
-            g_free((gpointer)dir_path);
+    if (!prefix)
+        return FALSE;
+
+    UIAppDir *dir = g_new0(UIAppDir, 1);
+    dir->path = g_strdup(path);
+    dir->id_prefix = prefix;
+    g_ptr_array_insert(data->dirs, (gint)position, dir);
+    return TRUE;
+}
+
+static gchar *resolve_desktop_id(const UIAppData *data, const char *id, UIAppCacheEntry *entry) {
+    for (guint i = 0; i < data->dirs->len; i++) {
+        const UIAppDir *dir = g_ptr_array_index(data->dirs, i);
+        if (!g_str_has_prefix(id, dir->id_prefix))
+            continue;
+
+        gchar *path = g_build_filename(dir->path, id + strlen(dir->id_prefix), NULL);
+        if (stat_stamp(path, FALSE, NULL, NULL)) {
+            parse_desktop_file(path, entry);
+            if (entry->flags & UI_APP_CACHE_ENTRY_PARSED)
+                return path;
+            free_entry_strings(entry);
+            *entry = (UIAppCacheEntry){0};
+        }
+        g_free(path);
     }
+    return NULL;
 }
 
-void ui_app_data_filter(UIAppData *data, const char *query) {
-    if (!data || !data->filtered_indices)
+gboolean ui_app_data_refresh_file(UIAppData *data, const char *path) {
+    if (!data || !data->apps || !path)
+        return FALSE;
+
+    gchar *id = desktop_id_for_path(data, path);
+    if (!id)
+        return FALSE;
+
+    gint existing = find_app_by_id(data, id);
+    UIAppCacheEntry entry = {0};
+    gchar *winner = resolve_desktop_id(data, id, &entry);
+
+    gboolean changed = FALSE;
+    data->revision++;
+    data->generation++;
+    if (entry_launchable(ui_path_index_valid(&data->commands) ? &data->commands : NULL, &entry)) {
+        if (existing >= 0)
+            replace_app(data, (guint)existing, id, winner, &entry);
+        else
+            append_app(data, id, winner, &entry, APP_NOT_INDEXED);
+        changed = TRUE;
+    } else if (existing >= 0) {
+        remove_app(data, (guint)existing);
+        changed = TRUE;
+    }
+    compact_apps(data);
+
+    free_entry_strings(&entry);
+    g_free(winner);
+    g_free(id);
+    return changed;
+}
+
+#define FRECENCY_BONUS_PER_BIT 6
+#define FRECENCY_BONUS_MAX 72
+
+static gboolean ranks_before(const UIAppMatch *a, const UIAppMatch *b) {
+    if (a->score != b->score)
+        return a->score > b->score;
+    return a->index < b->index;
+}
+
+static void heap_sift_down(UIAppMatch *heap, guint count, guint pos) {
+    for (;;) {
+        guint worst = pos;
+        guint left = pos * 2 + 1;
+        guint right = left + 1;
+        if (left < count && ranks_before(&heap[worst], &heap[left]))
+            worst = left;
+        if (right < count && ranks_before(&heap[worst], &heap[right]))
+            worst = right;
+        if (worst == pos)
+            return;
+
+        UIAppMatch tmp = heap[pos];
+        heap[pos] = heap[worst];
+        heap[worst] = tmp;
+        pos = worst;
+    }
+}
+
+static void heap_push(UIAppMatch *heap, guint *count, UIAppMatch item) {
+    if (*count < UI_APP_DATA_MAX_RESULTS) {
+        guint pos = (*count)++;
+        heap[pos] = item;
+        while (pos > 0) {
+            guint parent = (pos - 1) / 2;
+            if (!ranks_before(&heap[parent], &heap[pos]))
+                break;
+            UIAppMatch tmp = heap[pos];
+            heap[pos] = heap[parent];
+            heap[parent] = tmp;
+            pos = parent;
+        }
+    } else if (ranks_before(&item, &heap[0])) {
+        heap[0] = item;
+        heap_sift_down(heap, *count, 0);
+    }
+}
+
+static void store_ranked(GArray *results, UIAppMatch *heap, guint heap_count) {
+    g_array_set_size(results, heap_count);
+    UIAppMatch *ranked = (UIAppMatch *)(void *)results->data;
+    while (heap_count > 0) {
+        ranked[--heap_count] = heap[0];
+        heap[0] = heap[heap_count];
+        heap_sift_down(heap, heap_count, 0);
+    }
+}
+
+static gint frecency_bonus(guint frecency) {
+    if (frecency == 0)
+        return 0;
+    return MIN((gint)g_bit_storage(frecency) * FRECENCY_BONUS_PER_BIT, FRECENCY_BONUS_MAX);
+}
+
+static void rank_most_used(const UIAppData *data, GArray *results) {
+    UIAppMatch heap[UI_APP_DATA_MAX_RESULTS];
+    guint heap_count = 0;
+
+    const guint *frecency = (const guint *)(void *)data->frecency->data;
+    for (guint i = 0; i < data->frecency->len; i++) {
+        if (frecency[i] > 0)
+            heap_push(heap, &heap_count, (UIAppMatch){.score = (gint)MIN(frecency[i], (guint)G_MAXINT), .index = i});
+    }
+    store_ranked(results, heap, heap_count);
+}
+
+static void collect_candidates(const UIAppData *data, UIAppSearch *search, const char *folded_query, guint64 query_mask) {
+    if (search->last_query && search->revision == data->revision &&
+        g_str_has_prefix(folded_query, search->last_query))
         return;
 
-    g_array_set_size(data->filtered_indices, 0);
+    g_array_set_size(search->matches, data->apps->len);
+    guint found = ui_fuzzy_prefilter((const guint64 *)(void *)data->search_masks->data,
+                                     data->search_masks->len,
+                                     query_mask,
+                                     (guint *)(void *)search->matches->data);
+    g_array_set_size(search->matches, found);
+    search->revision = data->revision;
+}
+
+#define SEARCH_CANCEL_STRIDE 256
+#define SEARCH_TIER_SPAN (1 << 16)
+#define SEARCH_TIER_NAME 3
+#define SEARCH_MIN_FIELD_QUERY 3
+#define SEARCH_MAX_TRIGRAMS 64
+
+static const gint field_tiers[UI_APP_FIELD_COUNT] = {
+    [UI_APP_FIELD_GENERIC_NAME] = 2,
+    [UI_APP_FIELD_KEYWORDS] = 1,
+    [UI_APP_FIELD_COMMENT] = 0
+};
+
+typedef struct {
+    const guint32 *items;
+    guint count;
+} PostingList;
+
+static gint tiered_score(gint tier, gint score) {
+    return tier * SEARCH_TIER_SPAN + CLAMP(score, 0, SEARCH_TIER_SPAN - 1);
+}
+
+static gboolean posting_contains(const PostingList *list, guint32 value) {
+    guint lo = 0;
+    guint hi = list->count;
+    while (lo < hi) {
+        guint mid = lo + (hi - lo) / 2;
+        if (list->items[mid] == value)
+            return TRUE;
+        if (list->items[mid] < value)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return FALSE;
+}
+
+static void collect_indexed(const UIAppData *data, UIAppSearch *search, const char *folded_query) {
+    g_array_set_size(search->candidates, 0);
+    g_array_set_size(search->trigrams, 0);
+    ui_fuzzy_trigrams(folded_query, search->trigrams);
+    ui_fuzzy_sort_unique(search->trigrams);
+
+    PostingList lists[SEARCH_MAX_TRIGRAMS];
+    guint list_count = MIN(search->trigrams->len, (guint)SEARCH_MAX_TRIGRAMS);
+    guint shortest = 0;
+    for (guint i = 0; i < list_count; i++) {
+        lists[i].items = ui_app_cache_postings(&data->index, g_array_index(search->trigrams, guint32, i), &lists[i].count);
+        if (lists[i].count == 0)
+            return;
+        if (lists[i].count < lists[shortest].count)
+            shortest = i;
+    }
+
+    const guint32 *entry_apps = (const guint32 *)(void *)data->entry_apps->data;
+    for (guint p = 0; p < lists[shortest].count; p++) {
+        guint32 entry = lists[shortest].items[p];
+        if (entry >= data->entry_apps->len || entry_apps[entry] == APP_NOT_INDEXED)
+            continue;
+
+        gboolean all = TRUE;
+        for (guint i = 0; i < list_count && all; i++)
+            all = i == shortest || posting_contains(&lists[i], entry);
+        if (all)
+            g_array_append_val(search->candidates, entry_apps[entry]);
+    }
+}
+
+static void collect_unindexed(const UIAppData *data, UIAppSearch *search) {
+    if (data->unindexed == 0)
+        return;
+
+    const guint32 *app_entries = (const guint32 *)(void *)data->app_entries->data;
+    for (guint i = 0; i < data->app_entries->len; i++) {
+        if (app_entries[i] == APP_NOT_INDEXED)
+            g_array_append_val(search->candidates, i);
+    }
+}
+
+static gint field_score(const UIAppData *data, guint index, const char *folded_query) {
+    for (guint f = 0; f < UI_APP_FIELD_COUNT; f++) {
+        gint score = ui_fuzzy_substring_score(field_key(data, index, (UIAppField)f), folded_query);
+        if (score != UI_FUZZY_NO_MATCH)
+            return tiered_score(field_tiers[f], score + frecency_bonus(g_array_index(data->frecency, guint, index)));
+    }
+    return UI_FUZZY_NO_MATCH;
+}
+
+static gboolean rank_field_matches(const UIAppData *data, UIAppSearch *search, const char *folded_query,
+                                   UIAppMatch *heap, guint *heap_count,
+                                   UIAppSearchCancelled cancelled, gpointer user_data) {
+    if (strlen(folded_query) < SEARCH_MIN_FIELD_QUERY)
+        return TRUE;
+
+    collect_indexed(data, search, folded_query);
+    collect_unindexed(data, search);
+
+    const guint *candidates = (const guint *)(void *)search->candidates->data;
+    for (guint i = 0; i < search->candidates->len; i++) {
+        if (cancelled && i % SEARCH_CANCEL_STRIDE == 0 && cancelled(user_data))
+            return FALSE;
+        if (ui_fuzzy_score(search_key(data, candidates[i]), folded_query) != UI_FUZZY_NO_MATCH)
+            continue;
+
+        gint score = field_score(data, candidates[i], folded_query);
+        if (score != UI_FUZZY_NO_MATCH)
+            heap_push(heap, heap_count, (UIAppMatch){.score = score, .index = candidates[i]});
+    }
+    return TRUE;
+}
+
+typedef struct {
+    UIAppMatch *heap;
+    guint count;
+    UIAppSearchCancelled cancelled;
+    gpointer cancel_data;
+} RankedMatches;
+
+static void push_ranked_match(guint32 entry, gint score, gpointer user_data) {
+    RankedMatches *matches = (RankedMatches *)user_data;
+    heap_push(matches->heap, &matches->count, (UIAppMatch){.score = score, .index = entry});
+}
+
+static gboolean ranked_search_cancelled(gpointer user_data) {
+    RankedMatches *matches = (RankedMatches *)user_data;
+    return matches->cancelled && matches->cancelled(matches->cancel_data);
+}
 
-    if (!query || query[0] == '\0')
+gboolean ui_app_data_search_files(const UIAppData *data,
+                                  const char *query,
+                                  GArray *results,
+                                  UIAppSearchCancelled cancelled,
+                                  gpointer user_data) {
+    if (!data || !results)
+        return FALSE;
+
+    TRACE_SCOPE("ui_app_data_search_files");
+
+    g_array_set_size(results, 0);
+    gchar *folded_query = casefold_text(ui_app_data_is_file_query(query) ? query + 1 : query);
+    if (!folded_query)
+        return TRUE;
+
+    UIAppMatch heap[UI_APP_DATA_MAX_RESULTS];
+    RankedMatches matches = {.heap = heap, .count = 0, .cancelled = cancelled, .cancel_data = user_data};
+    gboolean done = ui_file_db_search(&data->files, folded_query, push_ranked_match, ranked_search_cancelled, &matches);
+    g_free(folded_query);
+    if (done)
+        store_ranked(results, heap, matches.count);
+    return done;
+}
+
+gboolean ui_app_data_search_lines(const UIAppData *data,
+                                  const char *query,
+                                  GArray *results,
+                                  UIAppSearchCancelled cancelled,
+                                  gpointer user_data) {
+    if (!data || !results)
+        return FALSE;
+
+    TRACE_SCOPE("ui_app_data_search_lines");
+
+    g_array_set_size(results, 0);
+    guint count = ui_line_store_count(&data->lines);
+    gchar *folded_query = casefold_text(query);
+    if (!folded_query) {
+        for (guint i = 0; i < MIN(count, (guint)UI_APP_DATA_MAX_RESULTS); i++) {
+            UIAppMatch match = {.score = 0, .index = i};
+            g_array_append_val(results, match);
+        }
+        return TRUE;
+    }
+
+    UIAppMatch heap[UI_APP_DATA_MAX_RESULTS];
+    RankedMatches matches = {.heap = heap, .count = 0, .cancelled = cancelled, .cancel_data = user_data};
+    gboolean done = ui_line_store_search(&data->lines, count, folded_query, push_ranked_match, ranked_search_cancelled,
+                                         &matches);
+    g_free(folded_query);
+    if (done)
+        store_ranked(results, heap, matches.count);
+    return done;
+}
+
+#define COMMAND_SCORE_EXACT 1000
+#define COMMAND_SCORE_PREFIX 500
+#define COMMAND_CANCEL_STRIDE 1024
+
+gboolean ui_app_data_search_commands(const UIAppData *data,
+                                     const char *query,
+                                     GArray *results,
+                                     UIAppSearchCancelled cancelled,
+                                     gpointer user_data) {
+    if (!data || !results)
+        return FALSE;
+
+    TRACE_SCOPE("ui_app_data_search_commands");
+
+    g_array_set_size(results, 0);
+    if (!query)
+        return TRUE;
+    if (ui_app_data_is_command_query(query))
+        query++;
+    while (g_ascii_isspace(*query))
+        query++;
+
+    gsize length = 0;
+    while (query[length] && !g_ascii_isspace(query[length]))
+        length++;
+    gchar *word = g_strndup(query, length);
+
+    guint first = 0;
+    guint count = ui_path_index_prefix_range(&data->commands, word, &first);
+    UIAppMatch heap[UI_APP_DATA_MAX_RESULTS];
+    guint heap_count = 0;
+    for (guint i = 0; i < count; i++) {
+        if (i % COMMAND_CANCEL_STRIDE == 0 && cancelled && cancelled(user_data)) {
+            g_free(word);
+            return FALSE;
+        }
+
+        gsize extra = strlen(ui_path_index_name(&data->commands, first + i)) - length;
+        gint score = extra == 0 ? COMMAND_SCORE_EXACT : COMMAND_SCORE_PREFIX - (gint)MIN(extra, (gsize)COMMAND_SCORE_PREFIX);
+        heap_push(heap, &heap_count, (UIAppMatch){.score = score, .index = first + i});
+    }
+    g_free(word);
+    store_ranked(results, heap, heap_count);
+    return TRUE;
+}
+
+void ui_app_search_init(UIAppSearch *search) {
+    if (!search)
         return;
 
-    gchar *lowered_query = casefold_text(query);
-    if (!lowered_query)
+    search->matches = g_array_new(FALSE, FALSE, sizeof(guint));
+    search->trigrams = g_array_new(FALSE, FALSE, sizeof(guint32));
+    search->candidates = g_array_new(FALSE, FALSE, sizeof(guint));
+    search->last_query = NULL;
+    search->revision = 0;
+}
+
+void ui_app_search_clear(UIAppSearch *search) {
+    if (!search)
         return;
 
-    for (guint i = 0; i < data->apps->len; i++) {
-        App *app = g_ptr_array_index(data->apps, i);
-        if (!app || !app->name)
+    if (search->matches)
+        g_array_free(search->matches, TRUE);
+    if (search->trigrams)
+        g_array_free(search->trigrams, TRUE);
+    if (search->candidates)
+        g_array_free(search->candidates, TRUE);
+    search->matches = NULL;
+    search->trigrams = NULL;
+    search->candidates = NULL;
+    g_clear_pointer(&search->last_query, g_free);
+}
+
+gboolean ui_app_data_search(const UIAppData *data,
+                            UIAppSearch *search,
+                            const char *query,
+                            GArray *results,
+                            UIAppSearchCancelled cancelled,
+                            gpointer user_data) {
+    if (!data || !data->apps || !search || !search->matches || !search->candidates || !results)
+        return FALSE;
+
+    TRACE_SCOPE("ui_app_data_search");
+
+    g_array_set_size(results, 0);
+    gchar *folded_query = casefold_text(query);
+    if (!folded_query) {
+        g_array_set_size(search->matches, 0);
+        g_clear_pointer(&search->last_query, g_free);
+        rank_most_used(data, results);
+        return TRUE;
+    }
+
+    collect_candidates(data, search, folded_query, ui_fuzzy_char_mask(folded_query));
+
+    UIAppMatch heap[UI_APP_DATA_MAX_RESULTS];
+    guint heap_count = 0;
+    guint *matches = (guint *)(void *)search->matches->data;
+    const guint *frecency = (const guint *)(void *)data->frecency->data;
+    guint kept = 0;
+
+    for (guint i = 0; i < search->matches->len; i++) {
+        if (cancelled && i % SEARCH_CANCEL_STRIDE == 0 && cancelled(user_data)) {
+            g_clear_pointer(&search->last_query, g_free);
+            g_free(folded_query);
+            return FALSE;
+        }
+
+        gint score = ui_fuzzy_score(search_key(data, matches[i]), folded_query);
+        if (score == UI_FUZZY_NO_MATCH)
             continue;
 
-        gchar *lowered_name = casefold_text(app->name);
-        if (lowered_name && g_strstr_len(lowered_name, -1, lowered_query)) {
-            g_array_append_val(data->filtered_indices, i);
+        matches[kept++] = matches[i];
+        score = tiered_score(SEARCH_TIER_NAME, score + frecency_bonus(frecency[matches[i]]));
+        heap_push(heap, &heap_count, (UIAppMatch){.score = score, .index = matches[i]});
+    }
+    g_array_set_size(search->matches, kept);
+
+    if (!rank_field_matches(data, search, folded_query, heap, &heap_count, cancelled, user_data)) {
+        g_clear_pointer(&search->last_query, g_free);
+        g_free(folded_query);
+        return FALSE;
+    }
+
+    store_ranked(results, heap, heap_count);
+
+    g_free(search->last_query);
+    search->last_query = folded_query;
+    return TRUE;
+}
+
+void ui_app_data_filter(UIAppData *data, const char *query) {
+    if (!data || !data->filtered_indices)
+        return;
+
+    data->generation++;
+    GArray *ranked = g_array_sized_new(FALSE, FALSE, sizeof(UIAppMatch), UI_APP_DATA_MAX_RESULTS);
+    ui_app_data_search(data, &data->search, query, ranked, NULL, NULL);
+    g_array_set_size(data->filtered_indices, ranked->len);
+    for (guint i = 0; i < ranked->len; i++)
+        g_array_index(data->filtered_indices, guint, i) = g_array_index(ranked, UIAppMatch, i).index;
+    g_array_free(ranked, TRUE);
+}
+
+static const char *copy_result_string(UIAppData *data, const char *text) {
+    return text ? g_string_chunk_insert(data->result_strings, text) : NULL;
+}
+
+void ui_app_data_set_results(UIAppData *data, const UIAppResult *results, guint count) {
+    if (!data || !data->filtered_indices || !data->result_apps)
+        return;
+
+    data->generation++;
+    g_string_chunk_clear(data->result_strings);
+    g_array_set_size(data->result_apps, 0);
+    g_array_set_size(data->filtered_indices, 0);
+
+    for (guint i = 0; results && i < count; i++) {
+        guint index = results[i].index;
+        if (index == UI_APP_RESULT_EXTERNAL) {
+            const App *source = &results[i].app;
+            App app = {
+                .id = copy_result_string(data, source->id),
+                .name = copy_result_string(data, source->name),
+                .exec = copy_result_string(data, source->exec),
+                .icon = copy_result_string(data, source->icon),
+                .path = copy_result_string(data, source->path),
+                .working_dir = copy_result_string(data, source->working_dir),
+                .terminal = source->terminal
+            };
+            index = UI_APP_RESULT_EXTERNAL | data->result_apps->len;
+            g_array_append_val(data->result_apps, app);
         }
-        g_free(lowered_name);
+        g_array_append_val(data->filtered_indices, index);
     }
+}
+
+gboolean ui_app_data_load_files(UIAppData *data) {
+    if (!data)
+        return FALSE;
+
+    gchar *path = ui_file_db_default_path();
+    gboolean ok = ui_file_db_open(&data->files, path);
+    g_free(path);
+    data->files_revision++;
+    return ok;
+}
+
+gboolean ui_app_data_is_file_query(const char *query) {
+    return query && query[0] == '/';
+}
+
+void ui_app_data_set_commands(UIAppData *data, UIPathIndex *commands) {
+    if (!data || !commands)
+        return;
 
-    g_free(lowered_query);
+    ui_path_index_close(&data->commands);
+    data->commands = *commands;
+    ui_path_index_init(commands);
+    data->commands_revision++;
+}
+
+gboolean ui_app_data_is_command_query(const char *query) {
+    return query && query[0] == '>';
+}
+
+guint ui_app_data_count(const UIAppData *data) {
+    if (!data || !data->apps)
+        return 0;
+    return data->apps->len;
 }
 
 guint ui_app_data_filtered_count(const UIAppData *data) {
@@ -141,14 +1339,40 @@ guint ui_app_data_filtered_index(const UIAppData *data, guint filtered_pos) {
     return g_array_index(data->filtered_indices, guint, filtered_pos);
 }
 
+const App *ui_app_data_filtered_app(const UIAppData *data, guint filtered_pos) {
+    if (!data || !data->filtered_indices || filtered_pos >= data->filtered_indices->len)
+        return NULL;
+
+    guint index = g_array_index(data->filtered_indices, guint, filtered_pos);
+    if (!(index & UI_APP_RESULT_EXTERNAL))
+        return ui_app_data_get(data, index);
+
+    index &= ~UI_APP_RESULT_EXTERNAL;
+    if (!data->result_apps || index >= data->result_apps->len)
+        return NULL;
+    return &g_array_index(data->result_apps, App, index);
+}
+
 const App *ui_app_data_get(const UIAppData *data, guint index) {
     if (!data || !data->apps || index >= data->apps->len)
         return NULL;
-    return g_ptr_array_index(data->apps, index);
+    return &g_array_index(data->apps, App, index);
 }
 
-void ui_app_launch(const App *app) {
-    if (!app || !app->exec)
+guint ui_app_data_frecency(const UIAppData *data, guint index) {
+    if (!data || !data->frecency || index >= data->frecency->len)
+        return 0;
+    return g_array_index(data->frecency, guint, index);
+}
+
+void ui_app_data_set_frecency(UIAppData *data, guint index, guint frecency) {
+    if (!data || !data->frecency || index >= data->frecency->len)
         return;
-    g_spawn_command_line_async(app->exec, NULL);
+    g_array_index(data->frecency, guint, index) = frecency;
+}
+
+gboolean ui_app_launch(const App *app) {
+    if (!app || !app->exec)
+        return FALSE;
+    return ui_app_exec_spawn(app->exec, app->working_dir, app->terminal);
 }
@@ -0,0 +1,212 @@
+#define _GNU_SOURCE
+#include "ui/ui_app_exec.h"
+#include "Trace.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define EXEC_DROPPED_CODES "fFuUdDnNvm"
+
+static const char *const terminal_candidates[] = {
+    "x-terminal-emulator", "foot", "kitty", "alacritty", "konsole", "xterm", NULL
+};
+
+static gboolean is_dropped_code(char code) {
+    return code != '\0' && strchr(EXEC_DROPPED_CODES, code) != NULL;
+}
+
+static gboolean has_dropped_code(const char *arg) {
+    for (const char *p = arg; *p; p++) {
+        if (*p != '%')
+            continue;
+
+        p++;
+        if (is_dropped_code(*p))
+            return TRUE;
+        if (!*p)
+            break;
+    }
+    return FALSE;
+}
+
+static gboolean append_token(GString *compiled, guint *count, const char *token) {
+    if (strchr(token, UI_APP_EXEC_SEPARATOR[0]) || (*count == 0 && *token == '\0'))
+        return FALSE;
+
+    if ((*count)++ > 0)
+        g_string_append_c(compiled, UI_APP_EXEC_SEPARATOR[0]);
+    g_string_append(compiled, token);
+    return TRUE;
+}
+
+static gboolean expand_token(GString *token, const char *arg, const char *name, const char *desktop_path) {
+    for (const char *p = arg; *p; p++) {
+        if (*p != '%') {
+            g_string_append_c(token, *p);
+            continue;
+        }
+
+        p++;
+        if (*p == '%')
+            g_string_append_c(token, '%');
+        else if (*p == 'c')
+            g_string_append(token, name ? name : "");
+        else if (*p == 'k')
+            g_string_append(token, desktop_path ? desktop_path : "");
+        else
+            return FALSE;
+    }
+    return TRUE;
+}
+
+gchar *ui_app_exec_compile(const char *exec, const char *name, const char *icon, const char *desktop_path) {
+    gint argc = 0;
+    gchar **argv = NULL;
+    if (!exec || !g_shell_parse_argv(exec, &argc, &argv, NULL))
+        return NULL;
+
+    GString *compiled = g_string_new(NULL);
+    GString *token = g_string_new(NULL);
+    guint count = 0;
+    gboolean valid = TRUE;
+    for (gint i = 0; i < argc && valid; i++) {
+        const char *arg = argv[i];
+        if (has_dropped_code(arg))
+            continue;
+
+        if (strcmp(arg, "%i") == 0) {
+            if (icon && *icon)
+                valid = append_token(compiled, &count, "--icon") && append_token(compiled, &count, icon);
+            continue;
+        }
+
+        g_string_truncate(token, 0);
+        valid = expand_token(token, arg, name, desktop_path) && append_token(compiled, &count, token->str);
+    }
+
+    g_string_free(token, TRUE);
+    g_strfreev(argv);
+    if (!valid || count == 0) {
+        g_string_free(compiled, TRUE);
+        return NULL;
+    }
+    return g_string_free(compiled, FALSE);
+}
+
+gboolean ui_app_exec_available(const UIPathIndex *commands, const char *try_exec) {
+    if (!try_exec || !*try_exec)
+        return TRUE;
+    if (g_path_is_absolute(try_exec))
+        return access(try_exec, X_OK) == 0;
+    if (ui_path_index_ready(commands) && !strchr(try_exec, '/'))
+        return ui_path_index_contains(commands, try_exec);
+
+    gchar *found = g_find_program_in_path(try_exec);
+    gboolean available = found != NULL;
+    g_free(found);
+    return available;
+}
+
+static const char *terminal_program(void) {
+    static gchar *terminal;
+    static gboolean resolved;
+    if (resolved)
+        return terminal;
+
+    resolved = TRUE;
+    const char *preferred = g_getenv("TERMINAL");
+    if (preferred && *preferred)
+        terminal = g_find_program_in_path(preferred);
+    for (guint i = 0; !terminal && terminal_candidates[i]; i++)
+        terminal = g_find_program_in_path(terminal_candidates[i]);
+    return terminal;
+}
+
+static char **child_environment(void) {
+    static char **environment;
+    if (environment)
+        return environment;
+
+    environment = g_get_environ();
+    environment = g_environ_unsetenv(environment, TRACE_ENV);
+    environment = g_environ_unsetenv(environment, "DESKTOP_STARTUP_ID");
+    environment = g_environ_unsetenv(environment, "XDG_ACTIVATION_TOKEN");
+    return environment;
+}
+
+static gchar **build_argv(const char *compiled, gboolean terminal) {
+    gchar **argv = g_strsplit(compiled, UI_APP_EXEC_SEPARATOR, -1);
+    if (!terminal)
+        return argv;
+
+    const char *program = terminal_program();
+    if (!program) {
+        g_strfreev(argv);
+        return NULL;
+    }
+
+    guint count = g_strv_length(argv);
+    gchar **wrapped = g_new0(gchar *, count + 3);
+    wrapped[0] = g_strdup(program);
+    wrapped[1] = g_strdup("-e");
+    memcpy(wrapped + 2, argv, count * sizeof(gchar *));
+    g_free(argv);
+    return wrapped;
+}
+
+gboolean ui_app_exec_spawn(const char *compiled, const char *working_dir, gboolean terminal) {
+    if (!compiled || !*compiled)
+        return FALSE;
+
+    TRACE_SCOPE("ui_app_exec_spawn");
+
+    gchar **argv = build_argv(compiled, terminal);
+    if (!argv)
+        return FALSE;
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+    if (working_dir && *working_dir)
+        posix_spawn_file_actions_addchdir_np(&actions, working_dir);
+
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    sigset_t signals;
+    sigemptyset(&signals);
+    posix_spawnattr_setsigmask(&attr, &signals);
+    sigfillset(&signals);
+    posix_spawnattr_setsigdefault(&attr, &signals);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSID | POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+
+    char **environment = child_environment();
+    int error = 0;
+    pid_t intermediate = fork();
+    if (intermediate == 0) {
+        pid_t pid = 0;
+        _exit(posix_spawnp(&pid, argv[0], &actions, &attr, argv, environment));
+    }
+
+    int status = 0;
+    pid_t waited = -1;
+    while (intermediate > 0 && (waited = waitpid(intermediate, &status, 0)) < 0 && errno == EINTR)
+        ;
+    if (waited < 0)
+        error = errno;
+    else if (!WIFEXITED(status))
+        error = ECHILD;
+    else
+        error = WEXITSTATUS(status);
+    if (error != 0)
+        g_printerr("waycast: could not launch %s: %s\n", argv[0], g_strerror(error));
+
+    posix_spawnattr_destroy(&attr);
+    posix_spawn_file_actions_destroy(&actions);
+    g_strfreev(argv);
+    return error == 0;
+}
+
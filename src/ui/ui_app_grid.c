@@ -1,11 +1,45 @@
 #include "ui/ui_app_grid.h"
+#include "Trace.h"
 #include <string.h>
 
+#define GRID_LABEL_CACHE_LIMIT 4096
+
+static void free_label(gpointer data) {
+    UIAppGridLabel *label = (UIAppGridLabel *)data;
+    if (!label)
+        return;
+    g_free(label->codepoints);
+    g_free(label);
+}
+
 void ui_app_grid_init(UIAppGrid *grid) {
     if (!grid)
         return;
     grid->selected_index = -1;
     grid->scroll_y = 0.0f;
+    grid->layer = (RenderTexture2D){0};
+    memset(&grid->layer_key, 0, sizeof(grid->layer_key));
+    grid->layer_valid = false;
+    grid->pending_cells = g_array_new(FALSE, FALSE, sizeof(guint));
+    grid->pending_serial = 0;
+    grid->labels = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, free_label);
+    grid->label_font_id = 0;
+    grid->label_font_size = 0;
+    grid->label_width = 0;
+}
+
+void ui_app_grid_free(UIAppGrid *grid) {
+    if (!grid)
+        return;
+    if (grid->layer.id != 0)
+        UnloadRenderTexture(grid->layer);
+    grid->layer = (RenderTexture2D){0};
+    grid->layer_valid = false;
+
+    if (grid->pending_cells)
+        g_array_free(grid->pending_cells, TRUE);
+    grid->pending_cells = NULL;
+    g_clear_pointer(&grid->labels, g_hash_table_destroy);
 }
 
 void ui_app_grid_reset(UIAppGrid *grid, guint filtered_count) {
@@ -15,6 +49,17 @@ void ui_app_grid_reset(UIAppGrid *grid, guint filtered_count) {
     grid->selected_index = (filtered_count > 0) ? 0 : -1;
 }
 
+void ui_app_grid_clamp(UIAppGrid *grid, guint filtered_count) {
+    if (!grid)
+        return;
+    if (filtered_count == 0)
+        grid->selected_index = -1;
+    else if (grid->selected_index < 0)
+        grid->selected_index = 0;
+    else if (grid->selected_index >= (int)filtered_count)
+        grid->selected_index = (int)filtered_count - 1;
+}
+
 int ui_app_grid_columns(int available_width, int cell_width, int cell_gap) {
     int cols = (available_width + cell_gap) / (cell_width + cell_gap);
     if (cols < 1)
@@ -67,6 +112,28 @@ void ui_app_grid_handle_scroll(UIAppGrid *grid, float max_scroll) {
     }
 }
 
+void ui_app_grid_handle_mouse(UIAppGrid *grid, Rectangle viewport, int cols, int cell_width, int cell_height, int cell_gap, guint filtered_count) {
+    if (!grid || !IsMouseButtonPressed(MOUSE_LEFT_BUTTON))
+        return;
+
+    Vector2 mouse = GetMousePosition();
+    if (!CheckCollisionPointRec(mouse, viewport))
+        return;
+
+    float rel_x = mouse.x - viewport.x;
+    float rel_y = mouse.y - viewport.y + grid->scroll_y;
+    float pitch_x = (float)(cell_width + cell_gap);
+    float pitch_y = (float)(cell_height + cell_gap);
+    int col = (int)(rel_x / pitch_x);
+    int row = (int)(rel_y / pitch_y);
+    if (col >= cols || rel_x - col * pitch_x >= cell_width || rel_y - row * pitch_y >= cell_height)
+        return;
+
+    guint index = (guint)row * (guint)cols + (guint)col;
+    if (index < filtered_count)
+        grid->selected_index = (int)index;
+}
+
 void ui_app_grid_ensure_visible(UIAppGrid *grid, int cols, float viewport_height, int cell_height, int cell_gap) {
     if (!grid || grid->selected_index < 0)
         return;
@@ -84,100 +151,244 @@ void ui_app_grid_ensure_visible(UIAppGrid *grid, int cols, float viewport_height
         grid->scroll_y = 0.0f;
 }
 
-static float measure_text_width(Font font, bool has_font, const char *text, int font_size) {
-    if (!text)
-        return 0.0f;
-    if (has_font)
-        return MeasureTextEx(font, text, (float)font_size, 0.0f).x;
-    return (float)MeasureText(text, font_size);
+static float glyph_advance(Font font, int codepoint, float scale) {
+    int index = GetGlyphIndex(font, codepoint);
+    float advance = font.glyphs[index].advanceX ? (float)font.glyphs[index].advanceX : font.recs[index].width;
+    return advance * scale;
+}
+
+static UIAppGridLabel *layout_label(UIGlyphAtlas *glyphs, const char *name, int font_size, float spacing, float max_width) {
+    GArray *codepoints = g_array_new(FALSE, FALSE, sizeof(int));
+    const int dot = '.';
+    g_array_append_val(codepoints, dot);
+    for (const char *ptr = name; *ptr;) {
+        int size = 0;
+        int codepoint = GetCodepointNext(ptr, &size);
+        ptr += size > 0 ? size : 1;
+        g_array_append_val(codepoints, codepoint);
+    }
+
+    Font font = ui_glyph_atlas_font(glyphs, font_size, (const int *)(void *)codepoints->data, (int)codepoints->len);
+    g_array_remove_index(codepoints, 0);
+
+    float scale = (float)font_size / (float)font.baseSize;
+    float ellipsis_width = glyph_advance(font, dot, scale) * 3.0f + spacing * 2.0f;
+    const int *values = (const int *)(void *)codepoints->data;
+    float width = 0.0f;
+    int fit = 0;
+    gboolean truncated = FALSE;
+
+    for (guint i = 0; i < codepoints->len; i++) {
+        width += (i > 0 ? spacing : 0.0f) + glyph_advance(font, values[i], scale);
+        if (width + spacing + ellipsis_width <= max_width)
+            fit = (int)i + 1;
+        if (width > max_width) {
+            truncated = TRUE;
+            break;
+        }
+    }
+
+    if (truncated) {
+        g_array_set_size(codepoints, (guint)fit);
+        for (int i = 0; i < 3; i++)
+            g_array_append_val(codepoints, dot);
+    }
+
+    UIAppGridLabel *label = g_new0(UIAppGridLabel, 1);
+    label->count = (int)codepoints->len;
+    label->codepoints = (int *)(void *)g_array_free(codepoints, FALSE);
+    return label;
+}
+
+static const UIAppGridLabel *grid_label(UIAppGrid *grid, UIGlyphAtlas *glyphs, const char *name, int font_size, float spacing, int max_width) {
+    Font font = ui_glyph_atlas_font(glyphs, font_size, NULL, 0);
+    if (grid->label_font_id != font.texture.id ||
+        grid->label_font_size != font_size ||
+        grid->label_width != max_width ||
+        g_hash_table_size(grid->labels) >= GRID_LABEL_CACHE_LIMIT) {
+        g_hash_table_remove_all(grid->labels);
+        grid->label_font_id = font.texture.id;
+        grid->label_font_size = font_size;
+        grid->label_width = max_width;
+    }
+
+    UIAppGridLabel *label = g_hash_table_lookup(grid->labels, name);
+    if (!label) {
+        label = layout_label(glyphs, name, font_size, spacing, (float)max_width);
+        g_hash_table_insert(grid->labels, g_strdup(name), label);
+    }
+    return label;
+}
+
+typedef struct {
+    UIGlyphAtlas *glyphs;
+    int font_size;
+    float spacing;
+    Color panel;
+    Color panel_border;
+    Color highlight;
+    Color highlight_border;
+    Color text;
+} CellStyle;
+
+static bool draw_cell(UIAppGrid *grid, const UIAppData *data, UIIconCache *icons, const CellStyle *style,
+                      guint pos, Rectangle cell, bool selected) {
+    Color fill = selected ? style->highlight : style->panel;
+    Color border = selected ? style->highlight_border : style->panel_border;
+    DrawRectangleRec(cell, fill);
+    DrawRectangleLinesEx(cell, 1.0f, border);
+
+    const App *app = ui_app_data_filtered_app(data, pos);
+    const char *name = (app && app->name) ? app->name : "";
+
+    const float icon_size = (float)UI_ICON_CACHE_ICON_SIZE;
+    Rectangle icon_rect = {cell.x + (cell.width - icon_size) / 2.0f, cell.y + 14.0f, icon_size, icon_size};
+    bool has_icon = ui_icon_cache_draw(icons, app ? app->icon : NULL, icon_rect, WHITE);
+    if (!has_icon)
+        DrawRectangleRounded(icon_rect, 0.25f, 6, Fade(border, 0.2f));
+
+    const UIAppGridLabel *label = grid_label(grid, style->glyphs, name, style->font_size, style->spacing, (int)cell.width - 16);
+    Font font = ui_glyph_atlas_font(style->glyphs, style->font_size, label->codepoints, label->count);
+    Vector2 label_pos = {cell.x + 8.0f, icon_rect.y + icon_size + 12.0f};
+    DrawTextCodepoints(font, label->codepoints, label->count, label_pos,
+                       (float)style->font_size, style->spacing, style->text);
+
+    return has_icon || !app || !app->icon || !*app->icon;
+}
+
+static Rectangle cell_rect(const UIAppGridLayerKey *key, guint pos) {
+    int row = (int)(pos / (guint)key->cols);
+    int col = (int)(pos % (guint)key->cols);
+    return (Rectangle){
+        col * (float)(key->cell_width + key->cell_gap),
+        row * (float)(key->cell_height + key->cell_gap) - key->scroll_y,
+        (float)key->cell_width,
+        (float)key->cell_height
+    };
+}
+
+static void visible_range(const UIAppGridLayerKey *key, guint filtered_count, guint *first, guint *last) {
+    float pitch = (float)(key->cell_height + key->cell_gap);
+    guint first_row = (guint)(key->scroll_y / pitch);
+    guint last_row = (guint)((key->scroll_y + key->viewport.height) / pitch);
+    *first = MIN(first_row * (guint)key->cols, filtered_count);
+    *last = MIN((last_row + 1) * (guint)key->cols, filtered_count);
+}
+
+static bool ensure_layer(UIAppGrid *grid, int width, int height) {
+    if (grid->layer.id != 0 && grid->layer.texture.width == width && grid->layer.texture.height == height)
+        return true;
+
+    if (grid->layer.id != 0)
+        UnloadRenderTexture(grid->layer);
+    grid->layer = LoadRenderTexture(width, height);
+    grid->layer_valid = false;
+    return grid->layer.id != 0;
+}
+
+static void render_layer(UIAppGrid *grid, const UIAppData *data, UIIconCache *icons, const CellStyle *style) {
+    TRACE_SCOPE("grid_render_layer");
+    const UIAppGridLayerKey *key = &grid->layer_key;
+    guint first;
+    guint last;
+    visible_range(key, ui_app_data_filtered_count(data), &first, &last);
+
+    g_array_set_size(grid->pending_cells, 0);
+    BeginTextureMode(grid->layer);
+    ClearBackground(BLANK);
+    for (guint i = first; i < last; i++) {
+        if (!draw_cell(grid, data, icons, style, i, cell_rect(key, i), false))
+            g_array_append_val(grid->pending_cells, i);
+    }
+    EndTextureMode();
+
+    grid->layer_valid = true;
+    grid->pending_serial = icons ? icons->upload_serial : 0;
+}
+
+static void refresh_pending_cells(UIAppGrid *grid, const UIAppData *data, UIIconCache *icons, const CellStyle *style) {
+    if (!icons || grid->pending_cells->len == 0 || grid->pending_serial == icons->upload_serial)
+        return;
+
+    guint kept = 0;
+    guint *cells = (guint *)(void *)grid->pending_cells->data;
+    BeginTextureMode(grid->layer);
+    for (guint i = 0; i < grid->pending_cells->len; i++) {
+        if (!draw_cell(grid, data, icons, style, cells[i], cell_rect(&grid->layer_key, cells[i]), false))
+            cells[kept++] = cells[i];
+    }
+    EndTextureMode();
+
+    g_array_set_size(grid->pending_cells, kept);
+    grid->pending_serial = icons->upload_serial;
 }
 
 void ui_app_grid_draw(UIAppGrid *grid,
                       const UIAppData *data,
+                      UIIconCache *icons,
                       Rectangle viewport,
                       int cols,
                       int cell_width,
                       int cell_height,
                       int cell_gap,
-                      Font font,
-                      bool has_font,
+                      UIGlyphAtlas *glyphs,
+                      int font_size,
                       Color panel_color,
                       Color panel_border,
                       Color highlight_color,
                       Color highlight_border,
                       Color text_color) {
-    if (!grid || !data)
+    if (!grid || !data || !grid->labels || viewport.width < 1.0f || viewport.height < 1.0f)
         return;
 
-    guint filtered_count = ui_app_data_filtered_count(data);
-    if (filtered_count == 0)
-        return;
+    TRACE_SCOPE("ui_app_grid_draw");
 
-    int mouse_x = GetMouseX();
-    int mouse_y = GetMouseY();
+    const bool has_font = ui_glyph_atlas_ready(glyphs);
+    CellStyle style = {
+        .glyphs = glyphs,
+        .font_size = font_size,
+        .spacing = has_font ? 0.0f : (float)(font_size / 10),
+        .panel = panel_color,
+        .panel_border = panel_border,
+        .highlight = highlight_color,
+        .highlight_border = highlight_border,
+        .text = text_color
+    };
 
-    for (guint i = 0; i < filtered_count; i++) {
-        int row = (int)i / cols;
-        int col = (int)i % cols;
-        float x = viewport.x + col * (float)(cell_width + cell_gap);
-        float y = viewport.y + row * (float)(cell_height + cell_gap) - grid->scroll_y;
+    UIAppGridLayerKey key = {
+        .viewport = viewport,
+        .scroll_y = grid->scroll_y,
+        .cols = cols,
+        .cell_width = cell_width,
+        .cell_height = cell_height,
+        .cell_gap = cell_gap,
+        .font_id = ui_glyph_atlas_font(glyphs, font_size, NULL, 0).texture.id,
+        .font_size = font_size,
+        .font_generation = ui_glyph_atlas_generation(glyphs, font_size),
+        .generation = data->generation,
+        .colors = {panel_color, panel_border, text_color}
+    };
 
-        if (y + cell_height < viewport.y || y > viewport.y + viewport.height)
-            continue;
-
-        Rectangle cell = {x, y, (float)cell_width, (float)cell_height};
-        bool is_selected = ((int)i == grid->selected_index);
-        Color fill = is_selected ? highlight_color : panel_color;
-        Color border = is_selected ? highlight_border : panel_border;
-
-        DrawRectangleRec(cell, fill);
-        DrawRectangleLinesEx(cell, 1.0f, border);
+    if (!ensure_layer(grid, (int)viewport.width, (int)viewport.height))
+        return;
 
-        guint app_idx = ui_app_data_filtered_index(data, i);
-        const App *app = ui_app_data_get(data, app_idx);
-        const char *name = app ? app->name : "";
+    if (!grid->layer_valid || memcmp(&key, &grid->layer_key, sizeof(key)) != 0) {
+        grid->layer_key = key;
+        render_layer(grid, data, icons, &style);
+    } else {
+        refresh_pending_cells(grid, data, icons, &style);
+    }
 
-        const int name_font = 16;
-        int max_width = cell_width - 16;
-        float width = measure_text_width(font, has_font, name, name_font);
-        Vector2 pos = {x + 8.0f, y + cell_height / 2.0f - 8.0f};
+    Rectangle source = {0.0f, 0.0f, (float)grid->layer.texture.width, -(float)grid->layer.texture.height};
+    DrawTextureRec(grid->layer.texture, source, (Vector2){viewport.x, viewport.y}, WHITE);
 
-        if (width > max_width) {
-            int chars = (int)strlen(name);
-            while (chars > 0) {
-                const char *candidate = TextSubtext(name, 0, chars);
-                float candidate_width = measure_text_width(font, has_font, candidate, name_font);
-                if (candidate_width <= max_width)
-                    break;
-                chars--;
-            }
-
-            if (chars > 3) {
-                char short_name[128];
-                if (chars > (int)sizeof(short_name) - 4)
-                    chars = (int)sizeof(short_name) - 4;
-                memcpy(short_name, name, (size_t)chars);
-                memcpy(short_name + chars, "...", 4);
-
-                if (has_font)
-                    DrawTextEx(font, short_name, pos, (float)name_font, 0.0f, text_color);
-                else
-                    DrawText(short_name, (int)pos.x, (int)pos.y, name_font, text_color);
-            } else {
-                if (has_font)
-                    DrawTextEx(font, name, pos, (float)name_font, 0.0f, text_color);
-                else
-                    DrawText(name, (int)pos.x, (int)pos.y, name_font, text_color);
-            }
-        } else {
-            if (has_font)
-                DrawTextEx(font, name, pos, (float)name_font, 0.0f, text_color);
-            else
-                DrawText(name, (int)pos.x, (int)pos.y, name_font, text_color);
-        }
+    if (grid->selected_index < 0 || (guint)grid->selected_index >= ui_app_data_filtered_count(data))
+        return;
 
-        if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON) && CheckCollisionPointRec((Vector2){(float)mouse_x, (float)mouse_y}, cell)) {
-            grid->selected_index = (int)i;
-        }
-    }
+    Rectangle cell = cell_rect(&key, (guint)grid->selected_index);
+    cell.x += viewport.x;
+    cell.y += viewport.y;
+    BeginScissorMode((int)viewport.x, (int)viewport.y, (int)viewport.width, (int)viewport.height);
+    draw_cell(grid, data, icons, &style, (guint)grid->selected_index, cell, true);
+    EndScissorMode();
 }
@@ -0,0 +1,208 @@
+#define _GNU_SOURCE
+#include "ui/ui_app_history.h"
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#define HISTORY_MAGIC "WHISTORY"
+#define HISTORY_VERSION 1
+#define HISTORY_COMPACT_MIN_RECORDS 1024
+
+#define SECONDS_PER_DAY (24 * 60 * 60)
+
+typedef struct {
+    char magic[8];
+    guint32 version;
+    guint32 record_size;
+} HistoryHeader;
+
+typedef struct {
+    guint64 key;
+    gint64 last_used;
+    guint32 count;
+    guint32 reserved;
+} HistoryRecord;
+
+typedef struct {
+    gint64 last_used;
+    guint32 count;
+} HistoryStat;
+
+static guint64 app_key(const App *app) {
+    if (!app || !app->id)
+        return 0;
+
+    guint64 hash = G_GUINT64_CONSTANT(14695981039346656037);
+    for (const guchar *p = (const guchar *)app->id; *p; p++) {
+        hash ^= *p;
+        hash *= G_GUINT64_CONSTANT(1099511628211);
+    }
+    return hash;
+}
+
+static guint32 recency_weight(gint64 age_seconds) {
+    if (age_seconds < SECONDS_PER_DAY)
+        return 100;
+    if (age_seconds < 7 * SECONDS_PER_DAY)
+        return 70;
+    if (age_seconds < 30 * SECONDS_PER_DAY)
+        return 50;
+    if (age_seconds < 90 * SECONDS_PER_DAY)
+        return 30;
+    return 10;
+}
+
+static void header_init(HistoryHeader *header) {
+    memset(header, 0, sizeof(*header));
+    memcpy(header->magic, HISTORY_MAGIC, sizeof(header->magic));
+    header->version = HISTORY_VERSION;
+    header->record_size = sizeof(HistoryRecord);
+}
+
+static gboolean header_valid(const void *data, gsize length) {
+    HistoryHeader expected;
+    header_init(&expected);
+    return data && length >= sizeof(expected) && memcmp(data, &expected, sizeof(expected)) == 0;
+}
+
+static void merge_record(GHashTable *stats, const HistoryRecord *record) {
+    HistoryStat *stat = g_hash_table_lookup(stats, &record->key);
+    if (!stat) {
+        guint64 *key = g_new(guint64, 1);
+        *key = record->key;
+        stat = g_new0(HistoryStat, 1);
+        g_hash_table_insert(stats, key, stat);
+    }
+
+    stat->count += record->count;
+    if (record->last_used > stat->last_used)
+        stat->last_used = record->last_used;
+}
+
+static void compact(UIAppHistory *history) {
+    HistoryHeader header;
+    header_init(&header);
+
+    GByteArray *blob = g_byte_array_sized_new(sizeof(header) + g_hash_table_size(history->stats) * sizeof(HistoryRecord));
+    g_byte_array_append(blob, (const guint8 *)&header, sizeof(header));
+
+    GHashTableIter iter;
+    gpointer key;
+    gpointer value;
+    g_hash_table_iter_init(&iter, history->stats);
+    while (g_hash_table_iter_next(&iter, &key, &value)) {
+        const HistoryStat *stat = value;
+        HistoryRecord record = {
+            .key = *(const guint64 *)key,
+            .last_used = stat->last_used,
+            .count = stat->count
+        };
+        g_byte_array_append(blob, (const guint8 *)&record, sizeof(record));
+    }
+
+    if (g_file_set_contents(history->path, (const gchar *)blob->data, blob->len, NULL))
+        history->record_count = g_hash_table_size(history->stats);
+    g_byte_array_free(blob, TRUE);
+}
+
+void ui_app_history_init(UIAppHistory *history) {
+    if (!history)
+        return;
+
+    history->path = g_build_filename(g_get_user_data_dir(), "waycast", "history.bin", NULL);
+    history->stats = g_hash_table_new_full(g_int64_hash, g_int64_equal, g_free, g_free);
+    history->record_count = 0;
+}
+
+void ui_app_history_free(UIAppHistory *history) {
+    if (!history)
+        return;
+
+    g_clear_pointer(&history->path, g_free);
+    g_clear_pointer(&history->stats, g_hash_table_destroy);
+    history->record_count = 0;
+}
+
+void ui_app_history_load(UIAppHistory *history) {
+    if (!history || !history->stats)
+        return;
+
+    g_hash_table_remove_all(history->stats);
+    history->record_count = 0;
+
+    GMappedFile *mapped = g_mapped_file_new(history->path, FALSE, NULL);
+    if (!mapped)
+        return;
+
+    gsize length = g_mapped_file_get_length(mapped);
+    const guint8 *base = (const guint8 *)g_mapped_file_get_contents(mapped);
+    gboolean valid = header_valid(base, length);
+    if (valid) {
+        guint count = (guint)((length - sizeof(HistoryHeader)) / sizeof(HistoryRecord));
+        const guint8 *records = base + sizeof(HistoryHeader);
+        for (guint i = 0; i < count; i++) {
+            HistoryRecord record;
+            memcpy(&record, records + i * sizeof(HistoryRecord), sizeof(record));
+            merge_record(history->stats, &record);
+        }
+        history->record_count = count;
+    }
+    g_mapped_file_unref(mapped);
+
+    if (!valid || (history->record_count >= HISTORY_COMPACT_MIN_RECORDS &&
+        history->record_count > 2 * g_hash_table_size(history->stats)))
+        compact(history);
+}
+
+void ui_app_history_apply(const UIAppHistory *history, UIAppData *data) {
+    if (!history || !history->stats || !data || !data->apps)
+        return;
+
+    gint64 now = g_get_real_time() / G_USEC_PER_SEC;
+    guint count = ui_app_data_count(data);
+    for (guint i = 0; i < count; i++) {
+        guint64 key = app_key(ui_app_data_get(data, i));
+        const HistoryStat *stat = g_hash_table_lookup(history->stats, &key);
+        ui_app_data_set_frecency(data, i, stat ? stat->count * recency_weight(now - stat->last_used) : 0);
+    }
+}
+
+void ui_app_history_record(UIAppHistory *history, const App *app) {
+    if (!history || !history->stats || !app)
+        return;
+
+    HistoryRecord record = {
+        .key = app_key(app),
+        .last_used = g_get_real_time() / G_USEC_PER_SEC,
+        .count = 1
+    };
+    merge_record(history->stats, &record);
+
+    gchar *dir_path = g_path_get_dirname(history->path);
+    g_mkdir_with_parents(dir_path, 0700);
+    g_free(dir_path);
+
+    int fd = open(history->path, O_RDWR | O_APPEND | O_CREAT | O_CLOEXEC, 0600);
+    if (fd < 0)
+        return;
+
+    HistoryHeader header;
+    off_t size = lseek(fd, 0, SEEK_END);
+    if (size < 0 || pread(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header) ||
+        !header_valid(&header, sizeof(header))) {
+        close(fd);
+        compact(history);
+        return;
+    }
+
+    gsize misaligned = (gsize)(size - (off_t)sizeof(HistoryHeader)) % sizeof(HistoryRecord);
+    if (misaligned != 0 && ftruncate(fd, size - (off_t)misaligned) != 0) {
+        close(fd);
+        return;
+    }
+
+    if (write(fd, &record, sizeof(record)) == (ssize_t)sizeof(record))
+        history->record_count++;
+    fdatasync(fd);
+    close(fd);
+}
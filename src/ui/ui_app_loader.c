@@ -0,0 +1,86 @@
+#include "ui/ui_app_loader.h"
+#include "Trace.h"
+#include <stdint.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+static void drain_wakeup(int fd) {
+    uint64_t count = 0;
+    while (fd >= 0 && read(fd, &count, sizeof(count)) == (ssize_t)sizeof(count))
+        ;
+}
+
+static gpointer loader_thread(gpointer user_data) {
+    UIAppLoader *loader = (UIAppLoader *)user_data;
+    g_atomic_pointer_set(&loader->load, ui_app_load_new(loader->watch_fd));
+
+    uint64_t one = 1;
+    if (loader->fd >= 0 && write(loader->fd, &one, sizeof(one)) != (ssize_t)sizeof(one))
+        g_printerr("waycast: could not signal catalog load\n");
+    return NULL;
+}
+
+void ui_app_loader_init(UIAppLoader *loader) {
+    if (!loader)
+        return;
+
+    memset(loader, 0, sizeof(*loader));
+    loader->fd = -1;
+    loader->watch_fd = -1;
+    loader->finished = true;
+}
+
+void ui_app_loader_start(UIAppLoader *loader, int watch_fd) {
+    if (!loader)
+        return;
+
+    ui_app_loader_init(loader);
+    loader->watch_fd = watch_fd;
+    loader->finished = false;
+    loader->fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    loader->thread = g_thread_new("waycast-catalog", loader_thread, loader);
+}
+
+void ui_app_loader_free(UIAppLoader *loader) {
+    if (!loader)
+        return;
+
+    if (loader->thread)
+        g_thread_join(loader->thread);
+    loader->thread = NULL;
+    g_clear_pointer(&loader->load, ui_app_load_free);
+    if (loader->fd >= 0)
+        close(loader->fd);
+    loader->fd = -1;
+}
+
+int ui_app_loader_fd(const UIAppLoader *loader) {
+    if (!loader || loader->finished)
+        return -1;
+    return loader->fd;
+}
+
+bool ui_app_loader_ready(const UIAppLoader *loader) {
+    return loader && !loader->finished && g_atomic_pointer_get(&loader->load);
+}
+
+bool ui_app_loader_finished(const UIAppLoader *loader) {
+    return !loader || loader->finished;
+}
+
+bool ui_app_loader_poll(UIAppLoader *loader, UIAppData *data) {
+    if (!ui_app_loader_ready(loader))
+        return false;
+
+    drain_wakeup(loader->fd);
+    if (ui_app_load_next(loader->load, data, UI_APP_LOADER_BATCH))
+        return true;
+
+    g_thread_join(loader->thread);
+    loader->thread = NULL;
+    g_clear_pointer(&loader->load, ui_app_load_free);
+    loader->finished = true;
+    trace_instant("catalog_ready");
+    return true;
+}
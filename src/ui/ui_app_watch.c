@@ -0,0 +1,227 @@
+#define _GNU_SOURCE
+#include "ui/ui_app_watch.h"
+#include <poll.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#define WATCH_EVENTS (IN_CREATE | IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE)
+#define WATCH_PARENT_EVENTS (IN_CREATE | IN_MOVED_TO | IN_MASK_ADD)
+#define WATCH_MAX_READS_PER_POLL 8
+
+void ui_app_watch_init(UIAppWatch *watch) {
+    if (!watch)
+        return;
+    watch->fd = -1;
+    watch->dirs = NULL;
+    watch->parents = NULL;
+    watch->missing = NULL;
+}
+
+static void touch_path(GHashTable **touched, gchar *path) {
+    if (!*touched)
+        *touched = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+    g_hash_table_add(*touched, path);
+}
+
+static void watch_new_dir(UIAppWatch *watch, UIAppData *data, const char *path, GHashTable **touched) {
+    if (!ui_app_data_add_dir(data, path))
+        return;
+
+    int wd = inotify_add_watch(watch->fd, path, WATCH_EVENTS | IN_ONLYDIR);
+    const char *watched = wd >= 0 ? g_hash_table_lookup(watch->dirs, GINT_TO_POINTER(wd)) : NULL;
+    if (wd < 0 || (watched && strcmp(watched, path) == 0))
+        return;
+    g_hash_table_replace(watch->dirs, GINT_TO_POINTER(wd), g_strdup(path));
+
+    GDir *dir = g_dir_open(path, 0, NULL);
+    if (!dir)
+        return;
+
+    const char *name;
+    while ((name = g_dir_read_name(dir))) {
+        gchar *child = g_build_filename(path, name, NULL);
+        if (g_file_test(child, G_FILE_TEST_IS_DIR) && !g_file_test(child, G_FILE_TEST_IS_SYMLINK)) {
+            watch_new_dir(watch, data, child, touched);
+            g_free(child);
+        } else if (g_str_has_suffix(name, ".desktop")) {
+            touch_path(touched, child);
+        } else {
+            g_free(child);
+        }
+    }
+    g_dir_close(dir);
+}
+
+static void touch_apps_under(const UIAppData *data, const char *path, GHashTable **touched) {
+    gchar *prefix = g_strconcat(path, "/", NULL);
+    for (guint i = 0; i < ui_app_data_count(data); i++) {
+        const App *app = &g_array_index(data->apps, App, i);
+        if (app->path && g_str_has_prefix(app->path, prefix))
+            touch_path(touched, g_strdup(app->path));
+    }
+    g_free(prefix);
+}
+
+static void watch_missing(UIAppWatch *watch, UIAppData *data, GHashTable **touched) {
+    for (guint i = 0; i < watch->missing->len;) {
+        const char *root = g_ptr_array_index(watch->missing, i);
+        if (g_file_test(root, G_FILE_TEST_IS_DIR)) {
+            watch_new_dir(watch, data, root, touched);
+            g_ptr_array_remove_index(watch->missing, i);
+            continue;
+        }
+
+        gchar *ancestor = g_path_get_dirname(root);
+        while (!g_file_test(ancestor, G_FILE_TEST_IS_DIR) && strcmp(ancestor, "/") != 0) {
+            gchar *next = g_path_get_dirname(ancestor);
+            g_free(ancestor);
+            ancestor = next;
+        }
+        int wd = inotify_add_watch(watch->fd, ancestor, WATCH_PARENT_EVENTS | IN_ONLYDIR);
+        if (wd >= 0)
+            g_hash_table_replace(watch->parents, GINT_TO_POINTER(wd), ancestor);
+        else
+            g_free(ancestor);
+        i++;
+    }
+}
+
+static gboolean refresh_touched(UIAppData *data, GHashTable *touched) {
+    if (!touched)
+        return FALSE;
+
+    gboolean changed = FALSE;
+    GHashTableIter iter;
+    gpointer path;
+    g_hash_table_iter_init(&iter, touched);
+    while (g_hash_table_iter_next(&iter, &path, NULL)) {
+        if (ui_app_data_refresh_file(data, path))
+            changed = TRUE;
+    }
+    g_hash_table_destroy(touched);
+    return changed;
+}
+
+static gboolean dir_registered(const UIAppData *data, const char *path) {
+    for (guint i = 0; i < data->dirs->len; i++) {
+        const UIAppDir *dir = g_ptr_array_index(data->dirs, i);
+        if (strcmp(dir->path, path) == 0)
+            return TRUE;
+    }
+    return FALSE;
+}
+
+gboolean ui_app_watch_open(UIAppWatch *watch) {
+    if (!watch)
+        return FALSE;
+    if (watch->fd < 0)
+        watch->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    return watch->fd >= 0;
+}
+
+int ui_app_watch_add_dir(int fd, const char *path) {
+    if (fd < 0 || !path)
+        return -1;
+    return inotify_add_watch(fd, path, WATCH_EVENTS | IN_ONLYDIR);
+}
+
+gboolean ui_app_watch_start(UIAppWatch *watch, UIAppData *data) {
+    if (!watch || !data || !data->dirs || watch->dirs || !ui_app_watch_open(watch))
+        return FALSE;
+
+    watch->dirs = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, g_free);
+    watch->parents = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, g_free);
+    watch->missing = g_ptr_array_new_with_free_func(g_free);
+
+    for (guint i = 0; i < data->dirs->len; i++) {
+        const UIAppDir *dir = g_ptr_array_index(data->dirs, i);
+        int wd = ui_app_watch_add_dir(watch->fd, dir->path);
+        if (wd >= 0)
+            g_hash_table_replace(watch->dirs, GINT_TO_POINTER(wd), g_strdup(dir->path));
+    }
+
+    GPtrArray *roots = ui_app_data_directories();
+    for (guint i = 0; i < roots->len; i++) {
+        if (!dir_registered(data, g_ptr_array_index(roots, i)))
+            g_ptr_array_add(watch->missing, g_strdup(g_ptr_array_index(roots, i)));
+    }
+    g_ptr_array_free(roots, TRUE);
+
+    GHashTable *touched = NULL;
+    watch_missing(watch, data, &touched);
+    return refresh_touched(data, touched);
+}
+
+void ui_app_watch_stop(UIAppWatch *watch) {
+    if (!watch)
+        return;
+
+    if (watch->fd >= 0)
+        close(watch->fd);
+    watch->fd = -1;
+    g_clear_pointer(&watch->dirs, g_hash_table_destroy);
+    g_clear_pointer(&watch->parents, g_hash_table_destroy);
+    if (watch->missing)
+        g_ptr_array_free(watch->missing, TRUE);
+    watch->missing = NULL;
+}
+
+int ui_app_watch_fd(const UIAppWatch *watch) {
+    return watch && watch->dirs ? watch->fd : -1;
+}
+
+gboolean ui_app_watch_ready(const UIAppWatch *watch) {
+    if (!watch || watch->fd < 0 || !watch->dirs)
+        return FALSE;
+
+    struct pollfd pfd = {.fd = watch->fd, .events = POLLIN};
+    return poll(&pfd, 1, 0) > 0 && (pfd.revents & POLLIN);
+}
+
+gboolean ui_app_watch_poll(UIAppWatch *watch, UIAppData *data) {
+    if (!watch || watch->fd < 0 || !watch->dirs || !data)
+        return FALSE;
+
+    GHashTable *touched = NULL;
+    gboolean parents_changed = FALSE;
+    char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+
+    for (int reads = 0; reads < WATCH_MAX_READS_PER_POLL; reads++) {
+        ssize_t len = read(watch->fd, buffer, sizeof(buffer));
+        if (len <= 0)
+            break;
+
+        for (char *ptr = buffer; ptr < buffer + len;) {
+            const struct inotify_event *event = (const struct inotify_event *)ptr;
+            ptr += sizeof(struct inotify_event) + event->len;
+
+            if (event->len == 0)
+                continue;
+
+            const char *dir_path = g_hash_table_lookup(watch->dirs, GINT_TO_POINTER(event->wd));
+            if (event->mask & IN_ISDIR) {
+                if (g_hash_table_contains(watch->parents, GINT_TO_POINTER(event->wd)))
+                    parents_changed = TRUE;
+                if (!dir_path)
+                    continue;
+
+                gchar *path = g_build_filename(dir_path, event->name, NULL);
+                if (event->mask & (IN_CREATE | IN_MOVED_TO))
+                    watch_new_dir(watch, data, path, &touched);
+                else if (event->mask & IN_MOVED_FROM)
+                    touch_apps_under(data, path, &touched);
+                g_free(path);
+                continue;
+            }
+
+            if (dir_path && g_str_has_suffix(event->name, ".desktop"))
+                touch_path(&touched, g_build_filename(dir_path, event->name, NULL));
+        }
+    }
+
+    if (parents_changed)
+        watch_missing(watch, data, &touched);
+
+    return refresh_touched(data, touched);
+}
@@ -0,0 +1,177 @@
+#include "ui/ui_calculator.h"
+#include "ui/ui_app_exec.h"
+#include <math.h>
+
+#define CALCULATOR_MAX_DEPTH 64
+#define CALCULATOR_SCORE (G_MAXINT / 2)
+#define CALCULATOR_COPY_COMMAND "wl-copy"
+#define CALCULATOR_ICON "accessories-calculator"
+
+typedef struct {
+    const char *pos;
+    guint depth;
+    guint operators;
+    gboolean ok;
+} CalcParser;
+
+static double parse_sum(CalcParser *parser);
+
+static void skip_space(CalcParser *parser) {
+    while (g_ascii_isspace(*parser->pos))
+        parser->pos++;
+}
+
+static gboolean accept_char(CalcParser *parser, char c) {
+    skip_space(parser);
+    if (*parser->pos != c)
+        return FALSE;
+    parser->pos++;
+    return TRUE;
+}
+
+static double parse_primary(CalcParser *parser) {
+    if (++parser->depth > CALCULATOR_MAX_DEPTH) {
+        parser->ok = FALSE;
+        return 0.0;
+    }
+
+    double value = 0.0;
+    skip_space(parser);
+    if (accept_char(parser, '-')) {
+        parser->operators++;
+        value = -parse_primary(parser);
+    } else if (accept_char(parser, '+')) {
+        value = parse_primary(parser);
+    } else if (accept_char(parser, '(')) {
+        value = parse_sum(parser);
+        if (!accept_char(parser, ')'))
+            parser->ok = FALSE;
+    } else if (g_ascii_isdigit(*parser->pos) || *parser->pos == '.') {
+        char *end = NULL;
+        value = g_ascii_strtod(parser->pos, &end);
+        if (!end || end == parser->pos)
+            parser->ok = FALSE;
+        else
+            parser->pos = end;
+    } else {
+        parser->ok = FALSE;
+    }
+
+    parser->depth--;
+    return value;
+}
+
+static double parse_power(CalcParser *parser) {
+    double base = parse_primary(parser);
+    if (parser->ok && accept_char(parser, '^')) {
+        parser->operators++;
+        return pow(base, parse_power(parser));
+    }
+    return base;
+}
+
+static double parse_product(CalcParser *parser) {
+    double value = parse_power(parser);
+    while (parser->ok) {
+        if (accept_char(parser, '*'))
+            value *= parse_power(parser);
+        else if (accept_char(parser, '/'))
+            value /= parse_power(parser);
+        else if (accept_char(parser, '%'))
+            value = fmod(value, parse_power(parser));
+        else
+            break;
+        parser->operators++;
+    }
+    return value;
+}
+
+static double parse_sum(CalcParser *parser) {
+    double value = parse_product(parser);
+    while (parser->ok) {
+        if (accept_char(parser, '+'))
+            value += parse_product(parser);
+        else if (accept_char(parser, '-'))
+            value -= parse_product(parser);
+        else
+            break;
+        parser->operators++;
+    }
+    return value;
+}
+
+static gboolean evaluate(const char *expression, double *value, guint *operators) {
+    if (!expression)
+        return FALSE;
+
+    CalcParser parser = {.pos = expression, .depth = 0, .operators = 0, .ok = TRUE};
+    double result = parse_sum(&parser);
+    skip_space(&parser);
+    if (!parser.ok || *parser.pos || !isfinite(result))
+        return FALSE;
+
+    if (value)
+        *value = result;
+    if (operators)
+        *operators = parser.operators;
+    return TRUE;
+}
+
+gboolean ui_calculator_eval(const char *expression, double *value) {
+    return evaluate(expression, value, NULL);
+}
+
+static gboolean calculator_accepts(const char *query) {
+    if (!query)
+        return FALSE;
+
+    while (g_ascii_isspace(*query))
+        query++;
+    return *query == '=' || *query == '(' || *query == '-' || *query == '.' || g_ascii_isdigit(*query);
+}
+
+static gboolean calculator_search(const UIAppData *data,
+                                  gpointer state,
+                                  const char *query,
+                                  UIProviderResults *results,
+                                  UIAppSearchCancelled cancelled,
+                                  gpointer user_data) {
+    (void)data;
+    (void)state;
+    (void)cancelled;
+    (void)user_data;
+
+    while (g_ascii_isspace(*query))
+        query++;
+    gboolean explicit = *query == '=';
+    if (explicit)
+        query++;
+
+    double value = 0.0;
+    guint operators = 0;
+    if (!evaluate(query, &value, &operators) || (!explicit && operators == 0))
+        return TRUE;
+
+    char text[G_ASCII_DTOSTR_BUF_SIZE];
+    g_ascii_formatd(text, sizeof(text), "%.12g", value == 0.0 ? 0.0 : value);
+    gchar *exec = g_strconcat(CALCULATOR_COPY_COMMAND, UI_APP_EXEC_SEPARATOR, text, NULL);
+    App app = {
+        .name = text,
+        .exec = exec,
+        .icon = CALCULATOR_ICON
+    };
+    ui_provider_results_add(results, CALCULATOR_SCORE, &app);
+    g_free(exec);
+    return TRUE;
+}
+
+const UIProvider ui_provider_calculator = {
+    .name = "calculator",
+    .budget_us = 4 * G_TIME_SPAN_MILLISECOND,
+    .timeout_us = 50 * G_TIME_SPAN_MILLISECOND,
+    .catalog = FALSE,
+    .accepts = calculator_accepts,
+    .state_new = NULL,
+    .state_free = NULL,
+    .search = calculator_search
+};
@@ -0,0 +1,382 @@
+#include "ui/ui_file_db.h"
+#include "ui/ui_fuzzy.h"
+#include <glib/gstdio.h>
+#include <string.h>
+
+#define FILE_DB_MAGIC "WFILESDB"
+#define FILE_DB_VERSION 1
+#define FILE_DB_BLOCK_ENTRIES 64
+#define FILE_DB_CANCEL_STRIDE 16
+#define FILE_DB_NAME_MAX 256
+#define FILE_DB_PATH_MAX 4096
+#define FILE_DB_DEPTH_PENALTY 2
+#define FILE_DB_DEPTH_MAX 16
+
+typedef struct {
+    char magic[8];
+    guint32 version;
+    guint32 entry_count;
+    guint32 block_count;
+    guint32 reserved;
+    guint64 data_size;
+} FileDbHeader;
+
+typedef struct {
+    guint64 mask;
+    guint32 offset;
+    guint32 first_entry;
+} FileDbBlock;
+
+static const FileDbBlock *db_blocks(const UIFileDb *db) {
+    return (const FileDbBlock *)(db->base + sizeof(FileDbHeader));
+}
+
+static const guint64 *db_masks(const UIFileDb *db) {
+    return (const guint64 *)(const void *)(db_blocks(db) + db->block_count);
+}
+
+static const guint8 *db_data(const UIFileDb *db) {
+    return (const guint8 *)(db_masks(db) + db->entry_count);
+}
+
+char *ui_file_db_default_path(void) {
+    return g_build_filename(g_get_user_cache_dir(), "waycast", "files.bin", NULL);
+}
+
+void ui_file_db_init(UIFileDb *db) {
+    if (!db)
+        return;
+    memset(db, 0, sizeof(*db));
+}
+
+gboolean ui_file_db_open(UIFileDb *db, const char *path) {
+    if (!db || !path)
+        return FALSE;
+
+    ui_file_db_close(db);
+
+    GMappedFile *mapped = g_mapped_file_new(path, FALSE, NULL);
+    if (!mapped)
+        return FALSE;
+
+    gsize length = g_mapped_file_get_length(mapped);
+    const guint8 *base = (const guint8 *)g_mapped_file_get_contents(mapped);
+    if (!base || length < sizeof(FileDbHeader)) {
+        g_mapped_file_unref(mapped);
+        return FALSE;
+    }
+
+    FileDbHeader header;
+    memcpy(&header, base, sizeof(header));
+    gsize expected = sizeof(FileDbHeader) + (gsize)header.block_count * sizeof(FileDbBlock) +
+                     (gsize)header.entry_count * sizeof(guint64) + header.data_size;
+    if (memcmp(header.magic, FILE_DB_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != FILE_DB_VERSION ||
+        header.block_count != (header.entry_count + FILE_DB_BLOCK_ENTRIES - 1) / FILE_DB_BLOCK_ENTRIES ||
+        header.data_size > G_MAXUINT32 ||
+        expected != length) {
+        g_mapped_file_unref(mapped);
+        return FALSE;
+    }
+
+    db->mapped = mapped;
+    db->base = base;
+    db->entry_count = header.entry_count;
+    db->block_count = header.block_count;
+    db->data_size = (gsize)header.data_size;
+
+    const FileDbBlock *blocks = db_blocks(db);
+    for (guint32 i = 0; i < db->block_count; i++) {
+        if (blocks[i].first_entry != i * FILE_DB_BLOCK_ENTRIES ||
+            blocks[i].offset >= db->data_size ||
+            (i > 0 && blocks[i].offset <= blocks[i - 1].offset)) {
+            ui_file_db_close(db);
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+void ui_file_db_close(UIFileDb *db) {
+    if (!db)
+        return;
+    if (db->mapped)
+        g_mapped_file_unref(db->mapped);
+    memset(db, 0, sizeof(*db));
+}
+
+guint ui_file_db_count(const UIFileDb *db) {
+    if (!db || !db->mapped)
+        return 0;
+    return db->entry_count;
+}
+
+static gboolean read_varint(const guint8 **ptr, const guint8 *end, guint64 *value) {
+    guint64 result = 0;
+    for (guint shift = 0; shift < 64 && *ptr < end; shift += 7) {
+        guint8 byte = *(*ptr)++;
+        result |= (guint64)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+static void write_varint(GByteArray *out, guint64 value) {
+    guint8 bytes[10];
+    guint count = 0;
+    do {
+        bytes[count] = value & 0x7f;
+        value >>= 7;
+        if (value)
+            bytes[count] |= 0x80;
+        count++;
+    } while (value);
+    g_byte_array_append(out, bytes, count);
+}
+
+typedef struct {
+    const guint8 *ptr;
+    const guint8 *end;
+    guint32 next;
+    guint32 stop;
+} BlockCursor;
+
+typedef struct {
+    char text[FILE_DB_PATH_MAX];
+    gsize length;
+} EntryPath;
+
+static void block_cursor(const UIFileDb *db, guint32 block, BlockCursor *cursor) {
+    const FileDbBlock *blocks = db_blocks(db);
+    const guint8 *data = db_data(db);
+    cursor->ptr = data + blocks[block].offset;
+    cursor->end = data + (block + 1 < db->block_count ? blocks[block + 1].offset : db->data_size);
+    cursor->next = blocks[block].first_entry;
+    cursor->stop = MIN(cursor->next + FILE_DB_BLOCK_ENTRIES, db->entry_count);
+}
+
+static gboolean decode_entry(BlockCursor *cursor, EntryPath *path, guint32 *flags, gint64 *mtime) {
+    guint64 shared = 0;
+    guint64 length = 0;
+    if (cursor->next >= cursor->stop ||
+        !read_varint(&cursor->ptr, cursor->end, &shared) ||
+        !read_varint(&cursor->ptr, cursor->end, &length) ||
+        shared > path->length ||
+        shared + length >= FILE_DB_PATH_MAX ||
+        length + 1 > (guint64)(cursor->end - cursor->ptr))
+        return FALSE;
+
+    memcpy(path->text + shared, cursor->ptr, (gsize)length);
+    path->length = (gsize)(shared + length);
+    path->text[path->length] = '\0';
+    cursor->ptr += length;
+    *flags = *cursor->ptr++;
+
+    guint64 stamp = 0;
+    if ((*flags & UI_FILE_DB_ENTRY_DIR) && !read_varint(&cursor->ptr, cursor->end, &stamp))
+        return FALSE;
+    *mtime = (gint64)stamp;
+    cursor->next++;
+    return TRUE;
+}
+
+gboolean ui_file_db_entry(const UIFileDb *db, guint32 index, GString *path, guint32 *flags) {
+    if (!db || !db->mapped || !path || index >= db->entry_count)
+        return FALSE;
+
+    BlockCursor cursor;
+    block_cursor(db, index / FILE_DB_BLOCK_ENTRIES, &cursor);
+
+    EntryPath entry = {.length = 0};
+    guint32 entry_flags = 0;
+    gint64 mtime = 0;
+    while (cursor.next <= index) {
+        if (!decode_entry(&cursor, &entry, &entry_flags, &mtime))
+            return FALSE;
+    }
+    g_string_assign(path, entry.text);
+    if (flags)
+        *flags = entry_flags;
+    return TRUE;
+}
+
+void ui_file_db_foreach(const UIFileDb *db, UIFileDbVisit visit, gpointer user_data) {
+    if (!db || !db->mapped || !visit)
+        return;
+
+    EntryPath *path = g_new(EntryPath, 1);
+    for (guint32 b = 0; b < db->block_count; b++) {
+        BlockCursor cursor;
+        block_cursor(db, b, &cursor);
+        path->length = 0;
+
+        guint32 flags = 0;
+        gint64 mtime = 0;
+        while (decode_entry(&cursor, path, &flags, &mtime))
+            visit(path->text, mtime, flags, user_data);
+    }
+    g_free(path);
+}
+
+static const char *base_name(const char *path) {
+    const char *slash = strrchr(path, '/');
+    return slash ? slash + 1 : path;
+}
+
+static const char *fold_name(const char *name, char *buffer) {
+    gsize length = 0;
+    for (; name[length] && length + 1 < FILE_DB_NAME_MAX; length++) {
+        guchar c = (guchar)name[length];
+        if (c >= 0x80)
+            break;
+        buffer[length] = (char)(c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c);
+    }
+    if (!name[length] || length + 1 >= FILE_DB_NAME_MAX) {
+        buffer[length] = '\0';
+        return buffer;
+    }
+
+    gchar *folded = g_utf8_casefold(name, -1);
+    g_strlcpy(buffer, folded, FILE_DB_NAME_MAX);
+    g_free(folded);
+    return buffer;
+}
+
+static gint path_depth(const char *path) {
+    gint depth = 0;
+    for (const char *p = path; *p; p++)
+        depth += *p == '/';
+    return MIN(depth, FILE_DB_DEPTH_MAX);
+}
+
+gboolean ui_file_db_search(const UIFileDb *db,
+                           const char *folded_query,
+                           UIFileDbMatch match,
+                           UIFileDbCancelled cancelled,
+                           gpointer user_data) {
+    if (!db || !db->mapped || !folded_query || !*folded_query || !match)
+        return TRUE;
+
+    guint64 query_mask = ui_fuzzy_char_mask(folded_query);
+    const FileDbBlock *blocks = db_blocks(db);
+    const guint64 *masks = db_masks(db);
+    EntryPath *path = g_new(EntryPath, 1);
+    char folded[FILE_DB_NAME_MAX];
+    guint candidates[FILE_DB_BLOCK_ENTRIES];
+
+    for (guint32 b = 0; b < db->block_count; b++) {
+        if (cancelled && b % FILE_DB_CANCEL_STRIDE == 0 && cancelled(user_data)) {
+            g_free(path);
+            return FALSE;
+        }
+        if ((blocks[b].mask & query_mask) != query_mask)
+            continue;
+
+        guint32 first = blocks[b].first_entry;
+        guint found = ui_fuzzy_prefilter(masks + first, MIN(db->entry_count - first, (guint32)FILE_DB_BLOCK_ENTRIES),
+                                         query_mask, candidates);
+        if (found == 0)
+            continue;
+
+        BlockCursor cursor;
+        block_cursor(db, b, &cursor);
+        path->length = 0;
+
+        guint32 flags = 0;
+        gint64 mtime = 0;
+        guint next = 0;
+        while (next < found && decode_entry(&cursor, path, &flags, &mtime)) {
+            guint32 entry = cursor.next - 1;
+            if (entry - first != candidates[next])
+                continue;
+            next++;
+
+            gint score = ui_fuzzy_score(fold_name(base_name(path->text), folded), folded_query);
+            if (score != UI_FUZZY_NO_MATCH)
+                match(entry, score - path_depth(path->text) * FILE_DB_DEPTH_PENALTY, user_data);
+        }
+    }
+
+    g_free(path);
+    return TRUE;
+}
+
+static gint compare_entries(gconstpointer a, gconstpointer b) {
+    return strcmp(((const UIFileDbEntry *)a)->path, ((const UIFileDbEntry *)b)->path);
+}
+
+static gsize shared_prefix(const char *a, const char *b) {
+    gsize length = 0;
+    while (a[length] && a[length] == b[length])
+        length++;
+    return length;
+}
+
+gboolean ui_file_db_write(const char *path, GArray *entries) {
+    if (!path || !entries)
+        return FALSE;
+
+    g_array_sort(entries, compare_entries);
+
+    GArray *blocks = g_array_new(FALSE, TRUE, sizeof(FileDbBlock));
+    GArray *masks = g_array_sized_new(FALSE, FALSE, sizeof(guint64), entries->len);
+    GByteArray *data = g_byte_array_new();
+    char folded[FILE_DB_NAME_MAX];
+    const char *previous = "";
+
+    for (guint i = 0; i < entries->len; i++) {
+        const UIFileDbEntry *entry = &g_array_index(entries, UIFileDbEntry, i);
+        if (!entry->path || strlen(entry->path) >= FILE_DB_PATH_MAX)
+            continue;
+
+        if (masks->len % FILE_DB_BLOCK_ENTRIES == 0) {
+            FileDbBlock block = {.mask = 0, .offset = data->len, .first_entry = masks->len};
+            g_array_append_val(blocks, block);
+            previous = "";
+        }
+
+        gsize shared = shared_prefix(previous, entry->path);
+        gsize length = strlen(entry->path + shared);
+        write_varint(data, shared);
+        write_varint(data, length);
+        g_byte_array_append(data, (const guint8 *)entry->path + shared, (guint)length);
+        guint8 flags = (guint8)entry->flags;
+        g_byte_array_append(data, &flags, 1);
+        if (entry->flags & UI_FILE_DB_ENTRY_DIR)
+            write_varint(data, (guint64)MAX(entry->mtime, 0));
+
+        guint64 mask = ui_fuzzy_char_mask(fold_name(base_name(entry->path), folded));
+        g_array_append_val(masks, mask);
+        g_array_index(blocks, FileDbBlock, blocks->len - 1).mask |= mask;
+        previous = entry->path;
+    }
+
+    FileDbHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, FILE_DB_MAGIC, sizeof(header.magic));
+    header.version = FILE_DB_VERSION;
+    header.entry_count = masks->len;
+    header.block_count = blocks->len;
+    header.data_size = data->len;
+
+    GByteArray *blob = g_byte_array_sized_new((guint)(sizeof(header) + blocks->len * sizeof(FileDbBlock) +
+                                                      masks->len * sizeof(guint64) + data->len));
+    g_byte_array_append(blob, (const guint8 *)&header, sizeof(header));
+    g_byte_array_append(blob, (const guint8 *)blocks->data, blocks->len * sizeof(FileDbBlock));
+    g_byte_array_append(blob, (const guint8 *)masks->data, masks->len * sizeof(guint64));
+    g_byte_array_append(blob, data->data, data->len);
+
+    gchar *dir_path = g_path_get_dirname(path);
+    g_mkdir_with_parents(dir_path, 0700);
+    g_free(dir_path);
+    gboolean ok = g_file_set_contents(path, (const gchar *)blob->data, (gssize)blob->len, NULL);
+
+    g_byte_array_free(blob, TRUE);
+    g_byte_array_free(data, TRUE);
+    g_array_free(masks, TRUE);
+    g_array_free(blocks, TRUE);
+    return ok;
+}
@@ -0,0 +1,313 @@
+#define _GNU_SOURCE
+#include "ui/ui_file_indexer.h"
+#include "Trace.h"
+#include "ui/ui_app_exec.h"
+#include "ui/ui_file_db.h"
+#include <dirent.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define FILE_INDEX_MAX_ENTRIES (1u << 20)
+#define FILE_INDEX_MAX_DEPTH 24
+#define FILE_INDEX_RESCAN_INTERVAL (5 * G_TIME_SPAN_MINUTE)
+
+typedef struct {
+    gint64 mtime;
+    GPtrArray *children;
+} KnownDir;
+
+typedef struct {
+    UIFileIndexer *indexer;
+    GHashTable *known;
+    GArray *entries;
+    guint listed;
+} FileScan;
+
+static void free_known_dir(gpointer data) {
+    KnownDir *dir = (KnownDir *)data;
+    if (!dir)
+        return;
+    g_ptr_array_free(dir->children, TRUE);
+    g_free(dir);
+}
+
+static KnownDir *known_dir(GHashTable *known, const char *path) {
+    KnownDir *dir = g_hash_table_lookup(known, path);
+    if (!dir) {
+        dir = g_new0(KnownDir, 1);
+        dir->mtime = -1;
+        dir->children = g_ptr_array_new_with_free_func(g_free);
+        g_hash_table_insert(known, g_strdup(path), dir);
+    }
+    return dir;
+}
+
+static void remember_entry(const char *path, gint64 mtime, guint32 flags, gpointer user_data) {
+    GHashTable *known = (GHashTable *)user_data;
+    gboolean is_dir = (flags & UI_FILE_DB_ENTRY_DIR) != 0;
+    if (is_dir)
+        known_dir(known, path)->mtime = mtime;
+
+    const char *slash = strrchr(path, '/');
+    if (!slash || slash == path)
+        return;
+
+    gchar *parent = g_strndup(path, (gsize)(slash - path));
+    g_ptr_array_add(known_dir(known, parent)->children, g_strconcat(is_dir ? "d" : "f", slash + 1, NULL));
+    g_free(parent);
+}
+
+static bool stat_dir(const char *path, gint64 *mtime) {
+    struct stat st;
+    if (lstat(path, &st) != 0 || !S_ISDIR(st.st_mode))
+        return false;
+
+    *mtime = (gint64)st.st_mtim.tv_sec * G_GINT64_CONSTANT(1000000000) + st.st_mtim.tv_nsec;
+    return true;
+}
+
+static bool indexable_name(const char *name) {
+    return name[0] != '.' && !strchr(name, UI_APP_EXEC_SEPARATOR[0]);
+}
+
+static GPtrArray *list_dir(const char *path) {
+    GPtrArray *children = g_ptr_array_new_with_free_func(g_free);
+    DIR *dir = opendir(path);
+    if (!dir)
+        return children;
+
+    struct dirent *ent;
+    while ((ent = readdir(dir))) {
+        if (!indexable_name(ent->d_name))
+            continue;
+
+        bool is_dir = ent->d_type == DT_DIR;
+        if (ent->d_type == DT_UNKNOWN) {
+            gchar *child_path = g_build_filename(path, ent->d_name, NULL);
+            gint64 mtime = 0;
+            is_dir = stat_dir(child_path, &mtime);
+            g_free(child_path);
+        }
+        g_ptr_array_add(children, g_strconcat(is_dir ? "d" : "f", ent->d_name, NULL));
+    }
+    closedir(dir);
+    return children;
+}
+
+static void add_entry(FileScan *scan, const char *path, gint64 mtime, guint32 flags) {
+    UIFileDbEntry entry = {.path = g_strdup(path), .mtime = mtime, .flags = flags};
+    g_array_append_val(scan->entries, entry);
+}
+
+static void scan_dir(FileScan *scan, const char *path, gint64 mtime, guint depth) {
+    if (g_atomic_int_get(&scan->indexer->quit) || scan->entries->len >= FILE_INDEX_MAX_ENTRIES)
+        return;
+
+    add_entry(scan, path, mtime, UI_FILE_DB_ENTRY_DIR);
+    if (depth >= FILE_INDEX_MAX_DEPTH)
+        return;
+
+    KnownDir *known = g_hash_table_lookup(scan->known, path);
+    bool reuse = known && known->mtime == mtime;
+    GPtrArray *children = reuse ? known->children : list_dir(path);
+    if (!reuse)
+        scan->listed++;
+
+    for (guint i = 0; i < children->len && scan->entries->len < FILE_INDEX_MAX_ENTRIES; i++) {
+        const char *child = g_ptr_array_index(children, i);
+        gchar *child_path = g_build_filename(path, child + 1, NULL);
+        gint64 child_mtime = 0;
+        if (child[0] == 'f')
+            add_entry(scan, child_path, 0, 0);
+        else if (stat_dir(child_path, &child_mtime))
+            scan_dir(scan, child_path, child_mtime, depth + 1);
+        g_free(child_path);
+    }
+
+    if (!reuse)
+        g_ptr_array_free(children, TRUE);
+}
+
+static gboolean run_scan(UIFileIndexer *indexer) {
+    TRACE_SCOPE("file_index_scan");
+
+    gint64 root_mtime = 0;
+    if (!indexer->root || !stat_dir(indexer->root, &root_mtime))
+        return FALSE;
+
+    FileScan scan = {
+        .indexer = indexer,
+        .known = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, free_known_dir),
+        .entries = g_array_new(FALSE, FALSE, sizeof(UIFileDbEntry)),
+        .listed = 0
+    };
+
+    UIFileDb previous;
+    ui_file_db_init(&previous);
+    if (ui_file_db_open(&previous, indexer->db_path)) {
+        ui_file_db_foreach(&previous, remember_entry, scan.known);
+        ui_file_db_close(&previous);
+    }
+
+    scan_dir(&scan, indexer->root, root_mtime, 0);
+    gboolean changed = !g_atomic_int_get(&indexer->quit) && scan.listed > 0 &&
+                       ui_file_db_write(indexer->db_path, scan.entries);
+
+    for (guint i = 0; i < scan.entries->len; i++)
+        g_free(g_array_index(scan.entries, UIFileDbEntry, i).path);
+    g_array_free(scan.entries, TRUE);
+    g_hash_table_destroy(scan.known);
+    return changed;
+}
+
+static void signal_ready(UIFileIndexer *indexer, gint *ready) {
+    g_atomic_int_set(ready, 1);
+
+    uint64_t one = 1;
+    if (indexer->fd >= 0 && write(indexer->fd, &one, sizeof(one)) != (ssize_t)sizeof(one))
+        g_printerr("waycast: could not signal file index\n");
+}
+
+static void drain_wakeup(int fd) {
+    uint64_t count = 0;
+    while (fd >= 0 && read(fd, &count, sizeof(count)) == (ssize_t)sizeof(count))
+        ;
+}
+
+static void load_commands(UIFileIndexer *indexer) {
+    if (g_atomic_int_get(&indexer->commands_ready))
+        return;
+
+    TRACE_SCOPE("path_index_load");
+    ui_path_index_close(&indexer->commands);
+    ui_path_index_load(&indexer->commands);
+    signal_ready(indexer, &indexer->commands_ready);
+}
+
+static gpointer indexer_thread(gpointer user_data) {
+    UIFileIndexer *indexer = (UIFileIndexer *)user_data;
+
+    g_mutex_lock(&indexer->mutex);
+    for (;;) {
+        while (!g_atomic_int_get(&indexer->quit) && !indexer->requested && !indexer->commands_requested)
+            g_cond_wait(&indexer->cond, &indexer->mutex);
+        if (g_atomic_int_get(&indexer->quit))
+            break;
+
+        gboolean scan = indexer->requested;
+        gboolean commands = indexer->commands_requested;
+        indexer->requested = FALSE;
+        indexer->commands_requested = FALSE;
+        indexer->running = scan;
+        g_mutex_unlock(&indexer->mutex);
+
+        if (commands)
+            load_commands(indexer);
+        if (scan && run_scan(indexer))
+            signal_ready(indexer, &indexer->ready);
+
+        g_mutex_lock(&indexer->mutex);
+        if (scan) {
+            indexer->running = FALSE;
+            indexer->last_scan = g_get_monotonic_time();
+        }
+    }
+    g_mutex_unlock(&indexer->mutex);
+    return NULL;
+}
+
+void ui_file_indexer_init(UIFileIndexer *indexer) {
+    if (!indexer)
+        return;
+
+    memset(indexer, 0, sizeof(*indexer));
+    g_mutex_init(&indexer->mutex);
+    g_cond_init(&indexer->cond);
+    indexer->root = g_strdup(g_get_home_dir());
+    indexer->db_path = ui_file_db_default_path();
+    indexer->fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    ui_path_index_init(&indexer->commands);
+    indexer->thread = g_thread_new("waycast-files", indexer_thread, indexer);
+}
+
+void ui_file_indexer_free(UIFileIndexer *indexer) {
+    if (!indexer || !indexer->thread)
+        return;
+
+    g_mutex_lock(&indexer->mutex);
+    g_atomic_int_set(&indexer->quit, 1);
+    g_cond_broadcast(&indexer->cond);
+    g_mutex_unlock(&indexer->mutex);
+    g_thread_join(indexer->thread);
+    indexer->thread = NULL;
+
+    g_clear_pointer(&indexer->root, g_free);
+    g_clear_pointer(&indexer->db_path, g_free);
+    ui_path_index_close(&indexer->commands);
+    if (indexer->fd >= 0)
+        close(indexer->fd);
+    indexer->fd = -1;
+    g_cond_clear(&indexer->cond);
+    g_mutex_clear(&indexer->mutex);
+}
+
+void ui_file_indexer_request(UIFileIndexer *indexer) {
+    if (!indexer || !indexer->thread)
+        return;
+
+    g_mutex_lock(&indexer->mutex);
+    if (!indexer->running && !indexer->requested &&
+        g_get_monotonic_time() - indexer->last_scan >= FILE_INDEX_RESCAN_INTERVAL) {
+        indexer->requested = TRUE;
+        g_cond_broadcast(&indexer->cond);
+    }
+    g_mutex_unlock(&indexer->mutex);
+}
+
+bool ui_file_indexer_ready(const UIFileIndexer *indexer) {
+    return indexer && indexer->thread && g_atomic_int_get(&indexer->ready);
+}
+
+bool ui_file_indexer_take(UIFileIndexer *indexer) {
+    if (!indexer)
+        return false;
+
+    drain_wakeup(indexer->fd);
+    return g_atomic_int_exchange(&indexer->ready, 0);
+}
+
+int ui_file_indexer_fd(const UIFileIndexer *indexer) {
+    if (!indexer || !indexer->thread)
+        return -1;
+    return indexer->fd;
+}
+
+void ui_file_indexer_request_commands(UIFileIndexer *indexer) {
+    if (!indexer || !indexer->thread)
+        return;
+
+    g_mutex_lock(&indexer->mutex);
+    if (!indexer->commands_requested && !g_atomic_int_get(&indexer->commands_ready)) {
+        indexer->commands_requested = TRUE;
+        g_cond_broadcast(&indexer->cond);
+    }
+    g_mutex_unlock(&indexer->mutex);
+}
+
+bool ui_file_indexer_commands_ready(const UIFileIndexer *indexer) {
+    return indexer && indexer->thread && g_atomic_int_get(&indexer->commands_ready);
+}
+
+bool ui_file_indexer_take_commands(UIFileIndexer *indexer, UIPathIndex *commands) {
+    if (!ui_file_indexer_commands_ready(indexer) || !commands)
+        return false;
+
+    drain_wakeup(indexer->fd);
+    *commands = indexer->commands;
+    ui_path_index_init(&indexer->commands);
+    g_atomic_int_set(&indexer->commands_ready, 0);
+    return true;
+}
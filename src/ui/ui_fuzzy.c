@@ -0,0 +1,199 @@
+#include "ui/ui_fuzzy.h"
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define SCORE_MATCH 16
+#define SCORE_PREFIX 48
+#define SCORE_BOUNDARY 24
+#define SCORE_CONSECUTIVE 20
+#define SCORE_EXACT_PREFIX 64
+#define PENALTY_GAP 3
+#define PENALTY_GAP_MAX 24
+#define MAX_START_ATTEMPTS 16
+
+static int mask_bit(guchar c) {
+    if (c >= 'a' && c <= 'z')
+        return c - 'a';
+    if (c >= '0' && c <= '9')
+        return 26 + (c - '0');
+    if (c >= 0x80)
+        return 63;
+    return 36 + (c % 27);
+}
+
+guint64 ui_fuzzy_char_mask(const char *folded) {
+    guint64 mask = 0;
+    if (!folded)
+        return mask;
+
+    for (const guchar *p = (const guchar *)folded; *p; p++)
+        mask |= G_GUINT64_CONSTANT(1) << mask_bit(*p);
+    return mask;
+}
+
+guint ui_fuzzy_prefilter(const guint64 *masks, guint count, guint64 query_mask, guint *candidates) {
+    if (!masks || !candidates)
+        return 0;
+
+    guint found = 0;
+    guint i = 0;
+
+#if defined(__SSE2__)
+    const __m128i query = _mm_set1_epi64x((long long)query_mask);
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 4 <= count; i += 4) {
+        __m128i missing_lo = _mm_andnot_si128(_mm_loadu_si128((const __m128i *)(masks + i)), query);
+        __m128i missing_hi = _mm_andnot_si128(_mm_loadu_si128((const __m128i *)(masks + i + 2)), query);
+        int lo = _mm_movemask_epi8(_mm_cmpeq_epi32(missing_lo, zero));
+        int hi = _mm_movemask_epi8(_mm_cmpeq_epi32(missing_hi, zero));
+        if ((lo | hi) == 0)
+            continue;
+
+        if ((lo & 0x00FF) == 0x00FF)
+            candidates[found++] = i;
+        if ((lo & 0xFF00) == 0xFF00)
+            candidates[found++] = i + 1;
+        if ((hi & 0x00FF) == 0x00FF)
+            candidates[found++] = i + 2;
+        if ((hi & 0xFF00) == 0xFF00)
+            candidates[found++] = i + 3;
+    }
+#endif
+
+    for (; i < count; i++) {
+        if ((masks[i] & query_mask) == query_mask)
+            candidates[found++] = i;
+    }
+    return found;
+}
+
+static gboolean is_boundary(const char *text, const char *pos) {
+    if (pos == text)
+        return TRUE;
+
+    guchar prev = (guchar)pos[-1];
+    return prev == ' ' || prev == '-' || prev == '_' || prev == '.' || prev == '/' || prev == '(' || prev == ';';
+}
+
+static const char *find_char(const char *pos, const char *query_char, gsize len) {
+    if (len == 1)
+        return strchr(pos, *query_char);
+
+    char needle[8];
+    memcpy(needle, query_char, len);
+    needle[len] = '\0';
+    return strstr(pos, needle);
+}
+
+static gint score_from(const char *text, const char *start, const char *query) {
+    const char *pos = start;
+    const char *prev_end = NULL;
+    gint score = 0;
+
+    for (const char *q = query; *q; q += g_utf8_skip[*(const guchar *)q]) {
+        gsize len = (gsize)g_utf8_skip[*(const guchar *)q];
+        const char *hit = find_char(pos, q, len);
+        if (!hit)
+            return UI_FUZZY_NO_MATCH;
+
+        score += SCORE_MATCH;
+        if (hit == text)
+            score += SCORE_PREFIX;
+        else if (is_boundary(text, hit))
+            score += SCORE_BOUNDARY;
+
+        if (prev_end) {
+            if (hit == prev_end)
+                score += SCORE_CONSECUTIVE;
+            else
+                score -= MIN((gint)(hit - prev_end) * PENALTY_GAP, PENALTY_GAP_MAX);
+        }
+
+        prev_end = hit + len;
+        pos = prev_end;
+    }
+
+    return score;
+}
+
+gint ui_fuzzy_score(const char *folded_text, const char *folded_query) {
+    if (!folded_text || !folded_query)
+        return UI_FUZZY_NO_MATCH;
+    if (!*folded_query)
+        return 0;
+
+    gsize first_len = (gsize)g_utf8_skip[*(const guchar *)folded_query];
+    gint best = UI_FUZZY_NO_MATCH;
+
+    const char *start = find_char(folded_text, folded_query, first_len);
+    for (int attempts = 0; start && attempts < MAX_START_ATTEMPTS; attempts++) {
+        gint score = score_from(folded_text, start, folded_query);
+        if (score == UI_FUZZY_NO_MATCH)
+            break;
+        if (score > best)
+            best = score;
+        start = find_char(start + first_len, folded_query, first_len);
+    }
+
+    if (best == UI_FUZZY_NO_MATCH)
+        return best;
+
+    if (g_str_has_prefix(folded_text, folded_query))
+        best += SCORE_EXACT_PREFIX;
+
+    best -= (gint)MIN(strlen(folded_text), 64) / 4;
+    return MAX(best, 1);
+}
+
+gint ui_fuzzy_substring_score(const char *folded_text, const char *folded_query) {
+    if (!folded_text || !folded_query || !*folded_query)
+        return UI_FUZZY_NO_MATCH;
+
+    gint best = UI_FUZZY_NO_MATCH;
+    for (const char *hit = strstr(folded_text, folded_query); hit; hit = strstr(hit + 1, folded_query)) {
+        gint score = SCORE_MATCH;
+        if (hit == folded_text)
+            score += SCORE_PREFIX;
+        else if (is_boundary(folded_text, hit))
+            score += SCORE_BOUNDARY;
+        best = MAX(best, score);
+        if (hit == folded_text)
+            break;
+    }
+    return best;
+}
+
+void ui_fuzzy_trigrams(const char *folded, GArray *trigrams) {
+    if (!folded || !trigrams)
+        return;
+
+    gsize len = strlen(folded);
+    const guchar *bytes = (const guchar *)folded;
+    for (gsize i = 0; i + 2 < len; i++) {
+        guint32 trigram = ((guint32)bytes[i] << 16) | ((guint32)bytes[i + 1] << 8) | bytes[i + 2];
+        g_array_append_val(trigrams, trigram);
+    }
+}
+
+static gint compare_uint32(gconstpointer a, gconstpointer b) {
+    guint32 x = *(const guint32 *)a;
+    guint32 y = *(const guint32 *)b;
+    return (x > y) - (x < y);
+}
+
+void ui_fuzzy_sort_unique(GArray *values) {
+    if (!values || values->len < 2)
+        return;
+
+    g_array_sort(values, compare_uint32);
+    guint32 *data = (guint32 *)(void *)values->data;
+    guint kept = 1;
+    for (guint i = 1; i < values->len; i++) {
+        if (data[i] != data[kept - 1])
+            data[kept++] = data[i];
+    }
+    g_array_set_size(values, kept);
+}
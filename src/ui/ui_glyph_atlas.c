@@ -0,0 +1,502 @@
+#define _GNU_SOURCE
+#include "ui/ui_glyph_atlas.h"
+#include "DataPath.h"
+#include "Trace.h"
+#include <glib/gstdio.h>
+#include <rlgl.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#define GLYPH_ATLAS_WIDTH 1024
+#define GLYPH_ATLAS_HEIGHT 1024
+#define GLYPH_PADDING 1
+#define GLYPH_MIN_SIZE 4
+#define GLYPH_MAX_SIZE 256
+#define GLYPH_REPLACEMENT '?'
+#define GLYPH_TEXT_CHUNK 64
+
+#define GLYPH_CACHE_MAGIC "WGLYPHS1"
+#define GLYPH_CACHE_VERSION 1
+
+typedef struct {
+    char magic[8];
+    guint32 version;
+    guint32 size;
+    guint64 key;
+    guint32 width;
+    guint32 height;
+    guint32 glyph_count;
+    guint32 pen_x;
+    guint32 pen_y;
+    guint32 row_height;
+} GlyphCacheHeader;
+
+typedef struct {
+    gint32 codepoint;
+    gint32 x;
+    gint32 y;
+    gint32 width;
+    gint32 height;
+    gint32 offset_x;
+    gint32 offset_y;
+    gint32 advance;
+} GlyphCacheRecord;
+
+static const char *const fallback_fonts[] = {
+    "/usr/share/fonts/noto/NotoSans-Regular.ttf",
+    "/usr/share/fonts/truetype/noto/NotoSans-Regular.ttf",
+    "/usr/share/fonts/TTF/DejaVuSans.ttf",
+    "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf",
+    "/usr/share/fonts/TTF/DroidSansFallbackFull.ttf",
+    "/usr/share/fonts/truetype/droid/DroidSansFallbackFull.ttf",
+    NULL
+};
+
+static void require_codepoints(UIGlyphAtlas *atlas, UIGlyphFace *face, const int *codepoints, int count);
+
+static void free_face(gpointer data) {
+    UIGlyphFace *face = (UIGlyphFace *)data;
+    if (!face)
+        return;
+
+    if (face->font.texture.id != 0)
+        UnloadTexture(face->font.texture);
+    g_array_free(face->glyph_info, TRUE);
+    g_array_free(face->glyph_recs, TRUE);
+    g_hash_table_destroy(face->glyphs);
+    g_free(face->alpha);
+    g_free(face);
+}
+
+void ui_glyph_atlas_init(UIGlyphAtlas *atlas) {
+    if (!atlas)
+        return;
+
+    atlas->sources = g_array_new(FALSE, TRUE, sizeof(UIGlyphSource));
+    atlas->faces = g_ptr_array_new_with_free_func(free_face);
+    atlas->key = 0;
+    atlas->ready = false;
+}
+
+static guint64 hash_bytes(guint64 hash, const void *data, gsize length) {
+    const guchar *bytes = (const guchar *)data;
+    for (gsize i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= G_GUINT64_CONSTANT(1099511628211);
+    }
+    return hash;
+}
+
+static bool add_source(UIGlyphAtlas *atlas, const char *path) {
+    GStatBuf st;
+    if (!path || g_stat(path, &st) != 0 || !S_ISREG(st.st_mode))
+        return false;
+
+    gint64 stamp[2] = {
+        (gint64)st.st_mtim.tv_sec * G_GINT64_CONSTANT(1000000000) + st.st_mtim.tv_nsec,
+        (gint64)st.st_size
+    };
+    atlas->key = hash_bytes(atlas->key, path, strlen(path) + 1);
+    atlas->key = hash_bytes(atlas->key, stamp, sizeof(stamp));
+
+    UIGlyphSource source = {.path = g_strdup(path)};
+    g_array_append_val(atlas->sources, source);
+    return true;
+}
+
+bool ui_glyph_atlas_open(UIGlyphAtlas *atlas, const char *relative_path) {
+    if (!atlas || !atlas->sources)
+        return false;
+
+    TRACE_SCOPE("glyph_atlas_open");
+    char *path = data_path_find(relative_path);
+    atlas->key = G_GUINT64_CONSTANT(14695981039346656037);
+    atlas->ready = add_source(atlas, path);
+    g_free(path);
+    if (!atlas->ready)
+        return false;
+
+    for (guint i = 0; fallback_fonts[i]; i++)
+        add_source(atlas, fallback_fonts[i]);
+    return true;
+}
+
+bool ui_glyph_atlas_ready(const UIGlyphAtlas *atlas) {
+    return atlas && atlas->ready;
+}
+
+static char *face_cache_path(int size) {
+    char *file_name = g_strdup_printf("glyphs-%d.bin", size);
+    char *path = g_build_filename(g_get_user_cache_dir(), "waycast", file_name, NULL);
+    g_free(file_name);
+    return path;
+}
+
+static guint8 *expand_alpha(const UIGlyphFace *face, int x, int y, int width, int height) {
+    guint8 *pixels = g_malloc((gsize)width * (gsize)height * 2);
+    for (int row = 0; row < height; row++) {
+        const guint8 *src = face->alpha + (gsize)(y + row) * GLYPH_ATLAS_WIDTH + x;
+        guint8 *dst = pixels + (gsize)row * (gsize)width * 2;
+        for (int col = 0; col < width; col++) {
+            dst[col * 2] = 255;
+            dst[col * 2 + 1] = src[col];
+        }
+    }
+    return pixels;
+}
+
+static void upload_rect(UIGlyphFace *face, int x, int y, int width, int height) {
+    if (face->font.texture.id == 0 || width <= 0 || height <= 0)
+        return;
+
+    guint8 *pixels = expand_alpha(face, x, y, width, height);
+    UpdateTextureRec(face->font.texture, (Rectangle){(float)x, (float)y, (float)width, (float)height}, pixels);
+    g_free(pixels);
+}
+
+static void append_glyph(UIGlyphFace *face, int codepoint, Rectangle rec, int offset_x, int offset_y, int advance) {
+    GlyphInfo info = {.value = codepoint, .offsetX = offset_x, .offsetY = offset_y, .advanceX = advance};
+    g_array_append_val(face->glyph_info, info);
+    g_array_append_val(face->glyph_recs, rec);
+    g_hash_table_insert(face->glyphs, GINT_TO_POINTER(codepoint), GUINT_TO_POINTER(face->glyph_info->len));
+
+    face->font.glyphs = (GlyphInfo *)(void *)face->glyph_info->data;
+    face->font.recs = (Rectangle *)(void *)face->glyph_recs->data;
+    face->font.glyphCount = (int)face->glyph_info->len;
+}
+
+static void reset_face(UIGlyphFace *face) {
+    rlDrawRenderBatchActive();
+    g_array_set_size(face->glyph_info, 0);
+    g_array_set_size(face->glyph_recs, 0);
+    g_hash_table_remove_all(face->glyphs);
+    face->font.glyphCount = 0;
+    memset(face->alpha, 0, (gsize)GLYPH_ATLAS_WIDTH * GLYPH_ATLAS_HEIGHT);
+    upload_rect(face, 0, 0, GLYPH_ATLAS_WIDTH, GLYPH_ATLAS_HEIGHT);
+    face->pen_x = 0;
+    face->pen_y = 0;
+    face->row_height = 0;
+    face->resets++;
+    face->dirty = true;
+}
+
+static void pack_glyph(UIGlyphFace *face, const GlyphInfo *glyph) {
+    int width = glyph->image.data ? glyph->image.width : 0;
+    int height = glyph->image.data ? glyph->image.height : 0;
+    if (width > GLYPH_ATLAS_WIDTH || height > GLYPH_ATLAS_HEIGHT)
+        width = height = 0;
+
+    if (face->pen_x + width > GLYPH_ATLAS_WIDTH) {
+        face->pen_x = 0;
+        face->pen_y += face->row_height + GLYPH_PADDING;
+        face->row_height = 0;
+    }
+    if (face->pen_y + height > GLYPH_ATLAS_HEIGHT)
+        reset_face(face);
+
+    const guint8 *src = (const guint8 *)glyph->image.data;
+    for (int row = 0; row < height; row++)
+        memcpy(face->alpha + (gsize)(face->pen_y + row) * GLYPH_ATLAS_WIDTH + face->pen_x, src + (gsize)row * width, (gsize)width);
+    upload_rect(face, face->pen_x, face->pen_y, width, height);
+
+    Rectangle rec = {(float)face->pen_x, (float)face->pen_y, (float)width, (float)height};
+    append_glyph(face, glyph->value, rec, glyph->offsetX, glyph->offsetY, glyph->advanceX);
+    face->pen_x += width + GLYPH_PADDING;
+    face->row_height = MAX(face->row_height, height);
+    face->dirty = true;
+}
+
+static void alias_replacement(UIGlyphAtlas *atlas, UIGlyphFace *face, int codepoint) {
+    if (codepoint == GLYPH_REPLACEMENT)
+        return;
+
+    const int replacement = GLYPH_REPLACEMENT;
+    require_codepoints(atlas, face, &replacement, 1);
+    gpointer slot = g_hash_table_lookup(face->glyphs, GINT_TO_POINTER(replacement));
+    if (!slot)
+        return;
+
+    guint index = GPOINTER_TO_UINT(slot) - 1;
+    GlyphInfo info = g_array_index(face->glyph_info, GlyphInfo, index);
+    Rectangle rec = g_array_index(face->glyph_recs, Rectangle, index);
+    append_glyph(face, codepoint, rec, info.offsetX, info.offsetY, info.advanceX);
+    face->dirty = true;
+}
+
+static bool load_source(UIGlyphSource *source) {
+    if (!source->loaded) {
+        source->loaded = true;
+        source->data = LoadFileData(source->path, &source->data_size);
+    }
+    return source->data != NULL;
+}
+
+static void rasterize(UIGlyphAtlas *atlas, UIGlyphFace *face, GArray *missing) {
+    TRACE_SCOPE("glyph_rasterize");
+    for (guint s = 0; s < atlas->sources->len && missing->len > 0; s++) {
+        UIGlyphSource *source = &g_array_index(atlas->sources, UIGlyphSource, s);
+        if (!load_source(source))
+            continue;
+
+        int count = (int)missing->len;
+        int *codepoints = (int *)(void *)missing->data;
+        GlyphInfo *glyphs = LoadFontData(source->data, source->data_size, face->size, codepoints, count, FONT_DEFAULT);
+        if (!glyphs)
+            continue;
+
+        guint kept = 0;
+        for (int i = 0; i < count; i++) {
+            if (glyphs[i].advanceX == 0 && !glyphs[i].image.data)
+                codepoints[kept++] = codepoints[i];
+            else
+                pack_glyph(face, &glyphs[i]);
+        }
+        UnloadFontData(glyphs, count);
+        g_array_set_size(missing, kept);
+    }
+
+    for (guint i = 0; i < missing->len; i++)
+        alias_replacement(atlas, face, g_array_index(missing, int, i));
+}
+
+static gint compare_codepoints(gconstpointer a, gconstpointer b) {
+    int x = *(const int *)a;
+    int y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+static void require_codepoints(UIGlyphAtlas *atlas, UIGlyphFace *face, const int *codepoints, int count) {
+    GArray *missing = NULL;
+    for (int i = 0; i < count; i++) {
+        if (g_hash_table_contains(face->glyphs, GINT_TO_POINTER(codepoints[i])))
+            continue;
+        if (!missing)
+            missing = g_array_new(FALSE, FALSE, sizeof(int));
+        g_array_append_val(missing, codepoints[i]);
+    }
+    if (!missing)
+        return;
+
+    g_array_sort(missing, compare_codepoints);
+    guint unique = 0;
+    int *values = (int *)(void *)missing->data;
+    for (guint i = 0; i < missing->len; i++) {
+        if (unique == 0 || values[unique - 1] != values[i])
+            values[unique++] = values[i];
+    }
+    g_array_set_size(missing, unique);
+
+    rasterize(atlas, face, missing);
+    g_array_free(missing, TRUE);
+}
+
+static bool load_face_cache(const UIGlyphAtlas *atlas, UIGlyphFace *face) {
+    TRACE_SCOPE("glyph_cache_load");
+    char *path = face_cache_path(face->size);
+    gchar *contents = NULL;
+    gsize length = 0;
+    bool ok = g_file_get_contents(path, &contents, &length, NULL) && length >= sizeof(GlyphCacheHeader);
+    g_free(path);
+
+    GlyphCacheHeader header;
+    gsize used_rows = 0;
+    if (ok) {
+        memcpy(&header, contents, sizeof(header));
+        ok = memcmp(header.magic, GLYPH_CACHE_MAGIC, sizeof(header.magic)) == 0 &&
+             header.version == GLYPH_CACHE_VERSION &&
+             header.size == (guint32)face->size &&
+             header.key == atlas->key &&
+             header.width == GLYPH_ATLAS_WIDTH &&
+             header.height == GLYPH_ATLAS_HEIGHT &&
+             header.pen_x <= GLYPH_ATLAS_WIDTH &&
+             header.pen_y <= GLYPH_ATLAS_HEIGHT &&
+             header.row_height <= GLYPH_ATLAS_HEIGHT - header.pen_y;
+    }
+    if (ok) {
+        used_rows = header.pen_y + header.row_height;
+        ok = header.glyph_count <= (length - sizeof(header)) / sizeof(GlyphCacheRecord) &&
+             length == sizeof(header) + header.glyph_count * sizeof(GlyphCacheRecord) + used_rows * GLYPH_ATLAS_WIDTH;
+    }
+
+    const GlyphCacheRecord *records = ok ? (const GlyphCacheRecord *)(const void *)(contents + sizeof(header)) : NULL;
+    for (guint32 i = 0; ok && i < header.glyph_count; i++) {
+        const GlyphCacheRecord *record = &records[i];
+        ok = record->x >= 0 && record->y >= 0 && record->width >= 0 && record->height >= 0 &&
+             record->x <= GLYPH_ATLAS_WIDTH - record->width &&
+             (gsize)record->y + (gsize)record->height <= used_rows;
+    }
+
+    if (ok) {
+        memcpy(face->alpha, records + header.glyph_count, used_rows * GLYPH_ATLAS_WIDTH);
+        for (guint32 i = 0; i < header.glyph_count; i++) {
+            const GlyphCacheRecord *record = &records[i];
+            Rectangle rec = {(float)record->x, (float)record->y, (float)record->width, (float)record->height};
+            append_glyph(face, record->codepoint, rec, record->offset_x, record->offset_y, record->advance);
+        }
+        face->pen_x = (int)header.pen_x;
+        face->pen_y = (int)header.pen_y;
+        face->row_height = (int)header.row_height;
+    }
+
+    g_free(contents);
+    return ok;
+}
+
+static void write_face_cache(const UIGlyphAtlas *atlas, const UIGlyphFace *face) {
+    GlyphCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, GLYPH_CACHE_MAGIC, sizeof(header.magic));
+    header.version = GLYPH_CACHE_VERSION;
+    header.size = (guint32)face->size;
+    header.key = atlas->key;
+    header.width = GLYPH_ATLAS_WIDTH;
+    header.height = GLYPH_ATLAS_HEIGHT;
+    header.glyph_count = face->glyph_info->len;
+    header.pen_x = (guint32)face->pen_x;
+    header.pen_y = (guint32)face->pen_y;
+    header.row_height = (guint32)face->row_height;
+
+    gsize used_rows = (gsize)(face->pen_y + face->row_height);
+    GByteArray *blob = g_byte_array_sized_new((guint)(sizeof(header) + header.glyph_count * sizeof(GlyphCacheRecord) +
+                                                      used_rows * GLYPH_ATLAS_WIDTH));
+    g_byte_array_append(blob, (const guint8 *)&header, sizeof(header));
+    for (guint i = 0; i < face->glyph_info->len; i++) {
+        const GlyphInfo *info = &g_array_index(face->glyph_info, GlyphInfo, i);
+        const Rectangle *rec = &g_array_index(face->glyph_recs, Rectangle, i);
+        GlyphCacheRecord record = {
+            .codepoint = info->value,
+            .x = (gint32)rec->x,
+            .y = (gint32)rec->y,
+            .width = (gint32)rec->width,
+            .height = (gint32)rec->height,
+            .offset_x = info->offsetX,
+            .offset_y = info->offsetY,
+            .advance = info->advanceX
+        };
+        g_byte_array_append(blob, (const guint8 *)&record, sizeof(record));
+    }
+    g_byte_array_append(blob, face->alpha, (guint)(used_rows * GLYPH_ATLAS_WIDTH));
+
+    char *path = face_cache_path(face->size);
+    gchar *dir_path = g_path_get_dirname(path);
+    g_mkdir_with_parents(dir_path, 0700);
+    g_free(dir_path);
+    g_file_set_contents(path, (const gchar *)blob->data, (gssize)blob->len, NULL);
+    g_free(path);
+    g_byte_array_free(blob, TRUE);
+}
+
+static UIGlyphFace *face_for(UIGlyphAtlas *atlas, int size) {
+    for (guint i = 0; i < atlas->faces->len; i++) {
+        UIGlyphFace *face = g_ptr_array_index(atlas->faces, i);
+        if (face->size == size)
+            return face;
+    }
+
+    UIGlyphFace *face = g_new0(UIGlyphFace, 1);
+    face->size = size;
+    face->glyph_info = g_array_new(FALSE, TRUE, sizeof(GlyphInfo));
+    face->glyph_recs = g_array_new(FALSE, TRUE, sizeof(Rectangle));
+    face->glyphs = g_hash_table_new(g_direct_hash, g_direct_equal);
+    face->alpha = g_malloc0((gsize)GLYPH_ATLAS_WIDTH * GLYPH_ATLAS_HEIGHT);
+    face->font.baseSize = size;
+    face->font.glyphPadding = 0;
+    load_face_cache(atlas, face);
+
+    guint8 *pixels = expand_alpha(face, 0, 0, GLYPH_ATLAS_WIDTH, GLYPH_ATLAS_HEIGHT);
+    Image image = {
+        .data = pixels,
+        .width = GLYPH_ATLAS_WIDTH,
+        .height = GLYPH_ATLAS_HEIGHT,
+        .mipmaps = 1,
+        .format = PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA
+    };
+    face->font.texture = LoadTextureFromImage(image);
+    g_free(pixels);
+
+    g_ptr_array_add(atlas->faces, face);
+    return face;
+}
+
+Font ui_glyph_atlas_font(UIGlyphAtlas *atlas, int size, const int *codepoints, int count) {
+    if (!ui_glyph_atlas_ready(atlas) || size < GLYPH_MIN_SIZE || size > GLYPH_MAX_SIZE)
+        return GetFontDefault();
+
+    UIGlyphFace *face = face_for(atlas, size);
+    const int replacement = GLYPH_REPLACEMENT;
+    guint resets = face->resets;
+    require_codepoints(atlas, face, &replacement, 1);
+    require_codepoints(atlas, face, codepoints, count);
+    if (face->resets != resets) {
+        require_codepoints(atlas, face, &replacement, 1);
+        require_codepoints(atlas, face, codepoints, count);
+    }
+    return face->font;
+}
+
+static void require_text(UIGlyphAtlas *atlas, UIGlyphFace *face, const char *text) {
+    const int replacement = GLYPH_REPLACEMENT;
+    require_codepoints(atlas, face, &replacement, 1);
+
+    int codepoints[GLYPH_TEXT_CHUNK];
+    int count = 0;
+    for (const char *ptr = text; *ptr;) {
+        int length = 0;
+        codepoints[count++] = GetCodepointNext(ptr, &length);
+        ptr += length > 0 ? length : 1;
+        if (count == GLYPH_TEXT_CHUNK || !*ptr) {
+            require_codepoints(atlas, face, codepoints, count);
+            count = 0;
+        }
+    }
+}
+
+Font ui_glyph_atlas_text_font(UIGlyphAtlas *atlas, int size, const char *text) {
+    Font font = ui_glyph_atlas_font(atlas, size, NULL, 0);
+    if (!ui_glyph_atlas_ready(atlas) || !text || size < GLYPH_MIN_SIZE || size > GLYPH_MAX_SIZE)
+        return font;
+
+    UIGlyphFace *face = face_for(atlas, size);
+    guint resets = face->resets;
+    require_text(atlas, face, text);
+    if (face->resets != resets)
+        require_text(atlas, face, text);
+    return face->font;
+}
+
+guint ui_glyph_atlas_generation(UIGlyphAtlas *atlas, int size) {
+    if (!ui_glyph_atlas_ready(atlas) || size < GLYPH_MIN_SIZE || size > GLYPH_MAX_SIZE)
+        return 0;
+    return face_for(atlas, size)->resets;
+}
+
+void ui_glyph_atlas_save(UIGlyphAtlas *atlas) {
+    if (!atlas || !atlas->faces)
+        return;
+
+    for (guint i = 0; i < atlas->faces->len; i++) {
+        UIGlyphFace *face = g_ptr_array_index(atlas->faces, i);
+        if (!face->dirty)
+            continue;
+        write_face_cache(atlas, face);
+        face->dirty = false;
+    }
+}
+
+void ui_glyph_atlas_free(UIGlyphAtlas *atlas) {
+    if (!atlas)
+        return;
+
+    g_clear_pointer(&atlas->faces, g_ptr_array_unref);
+    if (atlas->sources) {
+        for (guint i = 0; i < atlas->sources->len; i++) {
+            UIGlyphSource *source = &g_array_index(atlas->sources, UIGlyphSource, i);
+            if (source->data)
+                UnloadFileData(source->data);
+            g_free(source->path);
+        }
+        g_array_free(atlas->sources, TRUE);
+        atlas->sources = NULL;
+    }
+    atlas->ready = false;
+}
@@ -0,0 +1,293 @@
+#include "ui/ui_icon_cache.h"
+#include <string.h>
+
+#define ICON_SLOT_PADDING 1
+#define ICON_MAX_WORKERS 4
+
+typedef enum {
+    ICON_STATE_LOADING,
+    ICON_STATE_READY,
+    ICON_STATE_MISSING
+} IconState;
+
+struct UIIconEntry {
+    char *name;
+    IconState state;
+    gint slot;
+};
+
+typedef struct {
+    char *name;
+    guint64 serial;
+    Image image;
+    UIIconCache *cache;
+} IconJob;
+
+static void free_entry(gpointer data) {
+    UIIconEntry *entry = (UIIconEntry *)data;
+    if (!entry)
+        return;
+    g_free(entry->name);
+    g_free(entry);
+}
+
+static void free_job(IconJob *job) {
+    if (!job)
+        return;
+    if (job->image.data)
+        UnloadImage(job->image);
+    g_free(job->name);
+    g_free(job);
+}
+
+static gchar *resolve_icon_path(UIIconCache *cache, const char *name) {
+    if (g_path_is_absolute(name))
+        return g_file_test(name, G_FILE_TEST_IS_REGULAR) ? g_strdup(name) : NULL;
+
+    g_mutex_lock(&cache->theme_lock);
+    if (cache->theme_stale) {
+        gchar *theme_name = ui_icon_theme_default_name();
+        ui_icon_theme_load(&cache->theme, theme_name);
+        g_free(theme_name);
+        cache->theme_stale = FALSE;
+    }
+    gchar *found = ui_icon_theme_lookup(&cache->theme, name, UI_ICON_CACHE_ICON_SIZE);
+    g_mutex_unlock(&cache->theme_lock);
+    return found;
+}
+
+static void decode_icon(gpointer data, gpointer user_data) {
+    (void)user_data;
+    IconJob *job = (IconJob *)data;
+
+    if (!g_atomic_int_get(&job->cache->shutting_down)) {
+        gchar *path = resolve_icon_path(job->cache, job->name);
+        if (path) {
+            Image image = LoadImage(path);
+            if (image.data && image.width > 0 && image.height > 0) {
+                ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+                if (image.width != UI_ICON_CACHE_ICON_SIZE || image.height != UI_ICON_CACHE_ICON_SIZE)
+                    ImageResize(&image, UI_ICON_CACHE_ICON_SIZE, UI_ICON_CACHE_ICON_SIZE);
+                job->image = image;
+            } else if (image.data) {
+                UnloadImage(image);
+            }
+            g_free(path);
+        }
+    }
+
+    g_async_queue_push(job->cache->results, job);
+}
+
+static gint compare_jobs(gconstpointer a, gconstpointer b, gpointer user_data) {
+    (void)user_data;
+    guint64 serial_a = ((const IconJob *)a)->serial;
+    guint64 serial_b = ((const IconJob *)b)->serial;
+    return serial_a > serial_b ? -1 : serial_a < serial_b;
+}
+
+void ui_icon_cache_init(UIIconCache *cache) {
+    if (!cache)
+        return;
+
+    memset(cache, 0, sizeof(*cache));
+    cache->results = g_async_queue_new();
+    cache->entries = g_hash_table_new_full(g_str_hash, g_str_equal, NULL, free_entry);
+    g_mutex_init(&cache->theme_lock);
+    ui_icon_theme_init(&cache->theme);
+    cache->theme_stale = TRUE;
+
+    guint pitch = UI_ICON_CACHE_ICON_SIZE + ICON_SLOT_PADDING * 2;
+    guint per_row = UI_ICON_CACHE_ATLAS_SIZE / pitch;
+    cache->slots_per_atlas = per_row * per_row;
+    cache->slot_count = cache->slots_per_atlas * UI_ICON_CACHE_MAX_ATLASES;
+    cache->slots = g_new0(UIIconSlot, cache->slot_count);
+
+    gint workers = (gint)CLAMP(g_get_num_processors() / 2, 1, ICON_MAX_WORKERS);
+    cache->pool = g_thread_pool_new(decode_icon, NULL, workers, FALSE, NULL);
+    if (cache->pool)
+        g_thread_pool_set_sort_function(cache->pool, compare_jobs, NULL);
+}
+
+void ui_icon_cache_free(UIIconCache *cache) {
+    if (!cache)
+        return;
+
+    if (cache->pool) {
+        g_atomic_int_set(&cache->shutting_down, 1);
+        g_thread_pool_free(cache->pool, FALSE, TRUE);
+        cache->pool = NULL;
+    }
+
+    if (cache->results) {
+        IconJob *job;
+        while ((job = g_async_queue_try_pop(cache->results)) != NULL)
+            free_job(job);
+        g_async_queue_unref(cache->results);
+        cache->results = NULL;
+    }
+
+    for (int i = 0; i < cache->atlas_count; i++)
+        UnloadTexture(cache->atlases[i]);
+    cache->atlas_count = 0;
+
+    g_clear_pointer(&cache->entries, g_hash_table_destroy);
+    g_clear_pointer(&cache->slots, g_free);
+    cache->slot_count = 0;
+    cache->loading = 0;
+    ui_icon_theme_free(&cache->theme);
+    g_mutex_clear(&cache->theme_lock);
+}
+
+static Rectangle slot_rect(const UIIconCache *cache, guint slot) {
+    guint pitch = UI_ICON_CACHE_ICON_SIZE + ICON_SLOT_PADDING * 2;
+    guint per_row = UI_ICON_CACHE_ATLAS_SIZE / pitch;
+    guint local = slot % cache->slots_per_atlas;
+    return (Rectangle){
+        (float)((local % per_row) * pitch + ICON_SLOT_PADDING),
+        (float)((local / per_row) * pitch + ICON_SLOT_PADDING),
+        (float)UI_ICON_CACHE_ICON_SIZE,
+        (float)UI_ICON_CACHE_ICON_SIZE
+    };
+}
+
+static bool ensure_atlas(UIIconCache *cache, int atlas) {
+    while (cache->atlas_count <= atlas) {
+        Image blank = GenImageColor(UI_ICON_CACHE_ATLAS_SIZE, UI_ICON_CACHE_ATLAS_SIZE, BLANK);
+        Texture2D texture = LoadTextureFromImage(blank);
+        UnloadImage(blank);
+        if (texture.id == 0)
+            return false;
+
+        SetTextureFilter(texture, TEXTURE_FILTER_BILINEAR);
+        cache->atlases[cache->atlas_count++] = texture;
+    }
+    return true;
+}
+
+static gint claim_slot(UIIconCache *cache) {
+    gint victim = -1;
+    for (guint i = 0; i < cache->slot_count; i++) {
+        const UIIconSlot *slot = &cache->slots[i];
+        if (!slot->owner) {
+            if (ensure_atlas(cache, (int)(i / cache->slots_per_atlas)))
+                return (gint)i;
+            break;
+        }
+        if (victim < 0 || slot->last_used < cache->slots[victim].last_used)
+            victim = (gint)i;
+    }
+
+    if (victim < 0 || cache->slots[victim].last_used + 1 >= cache->frame)
+        return -1;
+
+    g_hash_table_remove(cache->entries, cache->slots[victim].owner->name);
+    cache->slots[victim].owner = NULL;
+    return victim;
+}
+
+bool ui_icon_cache_update(UIIconCache *cache) {
+    if (!cache || !cache->results)
+        return false;
+
+    cache->frame++;
+
+    int uploads = 0;
+    while (uploads < UI_ICON_CACHE_UPLOADS_PER_FRAME) {
+        IconJob *job = g_async_queue_try_pop(cache->results);
+        if (!job)
+            break;
+
+        cache->loading--;
+        UIIconEntry *entry = g_hash_table_lookup(cache->entries, job->name);
+        if (!entry || entry->state != ICON_STATE_LOADING) {
+            free_job(job);
+            continue;
+        }
+
+        if (!job->image.data) {
+            entry->state = ICON_STATE_MISSING;
+            free_job(job);
+            continue;
+        }
+
+        gint slot = claim_slot(cache);
+        if (slot < 0) {
+            g_hash_table_remove(cache->entries, job->name);
+            free_job(job);
+            continue;
+        }
+
+        Texture2D atlas = cache->atlases[(guint)slot / cache->slots_per_atlas];
+        UpdateTextureRec(atlas, slot_rect(cache, (guint)slot), job->image.data);
+        cache->slots[slot].owner = entry;
+        cache->slots[slot].last_used = cache->frame;
+        entry->state = ICON_STATE_READY;
+        entry->slot = slot;
+        cache->upload_serial++;
+        uploads++;
+        free_job(job);
+    }
+    return uploads > 0;
+}
+
+bool ui_icon_cache_pending(const UIIconCache *cache) {
+    return cache && cache->loading > 0;
+}
+
+static gboolean entry_missing(gpointer key, gpointer value, gpointer user_data) {
+    (void)key;
+    (void)user_data;
+    return ((const UIIconEntry *)value)->state == ICON_STATE_MISSING;
+}
+
+void ui_icon_cache_refresh(UIIconCache *cache) {
+    if (!cache || !cache->entries)
+        return;
+
+    g_mutex_lock(&cache->theme_lock);
+    cache->theme_stale = TRUE;
+    g_mutex_unlock(&cache->theme_lock);
+    g_hash_table_foreach_remove(cache->entries, entry_missing, NULL);
+}
+
+static void request_icon(UIIconCache *cache, const char *icon) {
+    UIIconEntry *entry = g_new0(UIIconEntry, 1);
+    entry->name = g_strdup(icon);
+    entry->state = ICON_STATE_MISSING;
+    entry->slot = -1;
+    g_hash_table_insert(cache->entries, entry->name, entry);
+
+    if (!cache->pool)
+        return;
+
+    IconJob *job = g_new0(IconJob, 1);
+    job->name = g_strdup(icon);
+    job->serial = ++cache->request_serial;
+    job->cache = cache;
+    if (g_thread_pool_push(cache->pool, job, NULL)) {
+        entry->state = ICON_STATE_LOADING;
+        cache->loading++;
+    } else {
+        free_job(job);
+    }
+}
+
+bool ui_icon_cache_draw(UIIconCache *cache, const char *icon, Rectangle dest, Color tint) {
+    if (!cache || !cache->entries || !icon || !*icon)
+        return false;
+
+    UIIconEntry *entry = g_hash_table_lookup(cache->entries, icon);
+    if (!entry) {
+        request_icon(cache, icon);
+        return false;
+    }
+    if (entry->state != ICON_STATE_READY)
+        return false;
+
+    UIIconSlot *slot = &cache->slots[entry->slot];
+    slot->last_used = cache->frame;
+    DrawTexturePro(cache->atlases[(guint)entry->slot / cache->slots_per_atlas],
+                   slot_rect(cache, (guint)entry->slot), dest, (Vector2){0.0f, 0.0f}, 0.0f, tint);
+    return true;
+}
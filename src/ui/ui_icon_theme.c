@@ -0,0 +1,646 @@
+#define _GNU_SOURCE
+#include "ui/ui_icon_theme.h"
+#include "Trace.h"
+#include <dirent.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#define ICON_THEME_MAGIC "WICONIX1"
+#define ICON_THEME_VERSION 1
+#define ICON_THEME_FALLBACK "hicolor"
+#define ICON_THEME_GROUP "Icon Theme"
+#define ICON_THEME_EXTENSION ".png"
+#define ICON_THEME_MIN_BUCKETS 16
+#define ICON_THEME_MAX_THEMES 32
+#define ICON_THEME_DEFAULT_THRESHOLD 2
+
+typedef enum {
+    ICON_DIR_THRESHOLD,
+    ICON_DIR_FIXED,
+    ICON_DIR_SCALABLE,
+    ICON_DIR_UNTHEMED
+} IconDirType;
+
+typedef struct {
+    char magic[8];
+    guint32 version;
+    guint32 stamp_count;
+    guint32 dir_count;
+    guint32 name_count;
+    guint32 file_count;
+    guint32 bucket_count;
+    guint32 strings_size;
+    guint32 inherits;
+} IconThemeHeader;
+
+typedef struct {
+    guint32 path;
+    guint32 reserved;
+    gint64 mtime;
+} IconStamp;
+
+typedef struct {
+    guint32 path;
+    guint16 size;
+    guint16 scale;
+    guint16 min_size;
+    guint16 max_size;
+    guint16 threshold;
+    guint8 type;
+    guint8 reserved;
+} IconDir;
+
+typedef struct {
+    guint32 name;
+    guint32 first_file;
+    guint32 file_count;
+} IconName;
+
+typedef struct {
+    char *name;
+    GMappedFile *mapped;
+    GByteArray *blob;
+    const guint8 *base;
+    IconThemeHeader header;
+} ThemeIndex;
+
+typedef struct {
+    GArray *stamps;
+    GArray *dirs;
+    GHashTable *names;
+    GByteArray *strings;
+} ThemeBuild;
+
+static const IconStamp *index_stamps(const ThemeIndex *index) {
+    return (const IconStamp *)(const void *)(index->base + sizeof(IconThemeHeader));
+}
+
+static const IconDir *index_dirs(const ThemeIndex *index) {
+    return (const IconDir *)(const void *)(index_stamps(index) + index->header.stamp_count);
+}
+
+static const IconName *index_names(const ThemeIndex *index) {
+    return (const IconName *)(const void *)(index_dirs(index) + index->header.dir_count);
+}
+
+static const guint32 *index_files(const ThemeIndex *index) {
+    return (const guint32 *)(const void *)(index_names(index) + index->header.name_count);
+}
+
+static const guint32 *index_buckets(const ThemeIndex *index) {
+    return index_files(index) + index->header.file_count;
+}
+
+static const char *index_strings(const ThemeIndex *index) {
+    return (const char *)(index_buckets(index) + index->header.bucket_count);
+}
+
+static guint32 hash_name(const char *name) {
+    guint32 hash = 2166136261u;
+    for (const guchar *p = (const guchar *)name; *p; p++) {
+        hash ^= *p;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static gint64 path_mtime(const char *path) {
+    struct stat st;
+    if (stat(path, &st) != 0)
+        return -1;
+    return (gint64)st.st_mtim.tv_sec * G_GINT64_CONSTANT(1000000000) + st.st_mtim.tv_nsec;
+}
+
+static gboolean valid_theme_name(const char *name) {
+    return name && *name && name[0] != '.' && !strchr(name, '/');
+}
+
+static GPtrArray *icon_base_dirs(void) {
+    GPtrArray *dirs = g_ptr_array_new_with_free_func(g_free);
+    g_ptr_array_add(dirs, g_build_filename(g_get_home_dir(), ".icons", NULL));
+    g_ptr_array_add(dirs, g_build_filename(g_get_user_data_dir(), "icons", NULL));
+    const gchar *const *system_dirs = g_get_system_data_dirs();
+    for (guint i = 0; system_dirs && system_dirs[i]; i++)
+        g_ptr_array_add(dirs, g_build_filename(system_dirs[i], "icons", NULL));
+    return dirs;
+}
+
+static GPtrArray *pixmap_dirs(void) {
+    GPtrArray *dirs = g_ptr_array_new_with_free_func(g_free);
+    g_ptr_array_add(dirs, g_build_filename(g_get_user_data_dir(), "pixmaps", NULL));
+    const gchar *const *system_dirs = g_get_system_data_dirs();
+    for (guint i = 0; system_dirs && system_dirs[i]; i++)
+        g_ptr_array_add(dirs, g_build_filename(system_dirs[i], "pixmaps", NULL));
+    return dirs;
+}
+
+static gchar *index_path(const char *name) {
+    gchar *file_name = name ? g_strconcat("theme-", name, ".bin", NULL) : g_strdup("unthemed.bin");
+    gchar *path = g_build_filename(g_get_user_cache_dir(), "waycast", "icons", file_name, NULL);
+    g_free(file_name);
+    return path;
+}
+
+static guint32 add_string(ThemeBuild *build, const char *text) {
+    guint32 offset = build->strings->len;
+    g_byte_array_append(build->strings, (const guint8 *)text, (guint)strlen(text) + 1);
+    return offset;
+}
+
+static gint64 add_stamp(ThemeBuild *build, const char *path) {
+    IconStamp stamp = {.path = add_string(build, path), .mtime = path_mtime(path)};
+    g_array_append_val(build->stamps, stamp);
+    return stamp.mtime;
+}
+
+static void add_dir(ThemeBuild *build, const char *path, IconDir info) {
+    if (add_stamp(build, path) < 0)
+        return;
+
+    DIR *dir = opendir(path);
+    if (!dir)
+        return;
+
+    guint32 dir_index = build->dirs->len;
+    info.path = g_array_index(build->stamps, IconStamp, build->stamps->len - 1).path;
+    g_array_append_val(build->dirs, info);
+
+    struct dirent *ent;
+    while ((ent = readdir(dir))) {
+        if (ent->d_name[0] == '.' || ent->d_type == DT_DIR || !g_str_has_suffix(ent->d_name, ICON_THEME_EXTENSION))
+            continue;
+
+        gchar *name = g_strndup(ent->d_name, strlen(ent->d_name) - strlen(ICON_THEME_EXTENSION));
+        GArray *files = g_hash_table_lookup(build->names, name);
+        if (!files) {
+            files = g_array_new(FALSE, FALSE, sizeof(guint32));
+            g_hash_table_insert(build->names, name, files);
+        } else {
+            g_free(name);
+        }
+        g_array_append_val(files, dir_index);
+    }
+    closedir(dir);
+}
+
+static IconDir read_dir_info(GKeyFile *keys, const char *group) {
+    guint16 size = (guint16)CLAMP(g_key_file_get_integer(keys, group, "Size", NULL), 0, G_MAXUINT16);
+    IconDir info = {
+        .size = size,
+        .scale = 1,
+        .min_size = size,
+        .max_size = size,
+        .threshold = ICON_THEME_DEFAULT_THRESHOLD,
+        .type = ICON_DIR_THRESHOLD
+    };
+
+    if (g_key_file_has_key(keys, group, "Scale", NULL))
+        info.scale = (guint16)CLAMP(g_key_file_get_integer(keys, group, "Scale", NULL), 1, G_MAXUINT16);
+    if (g_key_file_has_key(keys, group, "MinSize", NULL))
+        info.min_size = (guint16)CLAMP(g_key_file_get_integer(keys, group, "MinSize", NULL), 0, G_MAXUINT16);
+    if (g_key_file_has_key(keys, group, "MaxSize", NULL))
+        info.max_size = (guint16)CLAMP(g_key_file_get_integer(keys, group, "MaxSize", NULL), 0, G_MAXUINT16);
+    if (g_key_file_has_key(keys, group, "Threshold", NULL))
+        info.threshold = (guint16)CLAMP(g_key_file_get_integer(keys, group, "Threshold", NULL), 0, G_MAXUINT16);
+
+    gchar *type = g_key_file_get_string(keys, group, "Type", NULL);
+    if (g_strcmp0(type, "Fixed") == 0)
+        info.type = ICON_DIR_FIXED;
+    else if (g_strcmp0(type, "Scalable") == 0)
+        info.type = ICON_DIR_SCALABLE;
+    g_free(type);
+    return info;
+}
+
+static void scan_theme(ThemeBuild *build, const char *name, guint32 *inherits) {
+    GPtrArray *bases = icon_base_dirs();
+    GKeyFile *keys = NULL;
+    for (guint i = 0; i < bases->len; i++) {
+        gchar *root = g_build_filename(g_ptr_array_index(bases, i), name, NULL);
+        gchar *index_file = g_build_filename(root, "index.theme", NULL);
+        add_stamp(build, root);
+        if (add_stamp(build, index_file) >= 0 && !keys) {
+            keys = g_key_file_new();
+            g_key_file_set_list_separator(keys, ',');
+            if (!g_key_file_load_from_file(keys, index_file, G_KEY_FILE_NONE, NULL))
+                g_clear_pointer(&keys, g_key_file_free);
+        }
+        g_free(index_file);
+        g_free(root);
+    }
+
+    if (keys) {
+        gchar *parents = g_key_file_get_string(keys, ICON_THEME_GROUP, "Inherits", NULL);
+        if (parents)
+            *inherits = add_string(build, parents);
+        g_free(parents);
+
+        const char *const lists[] = {"Directories", "ScaledDirectories"};
+        for (guint l = 0; l < G_N_ELEMENTS(lists); l++) {
+            gchar **subdirs = g_key_file_get_string_list(keys, ICON_THEME_GROUP, lists[l], NULL, NULL);
+            for (guint s = 0; subdirs && subdirs[s]; s++) {
+                if (!*subdirs[s] || !g_key_file_has_group(keys, subdirs[s]))
+                    continue;
+
+                IconDir info = read_dir_info(keys, subdirs[s]);
+                if (info.size == 0)
+                    continue;
+                for (guint i = 0; i < bases->len; i++) {
+                    gchar *path = g_build_filename(g_ptr_array_index(bases, i), name, subdirs[s], NULL);
+                    add_dir(build, path, info);
+                    g_free(path);
+                }
+            }
+            g_strfreev(subdirs);
+        }
+        g_key_file_free(keys);
+    }
+    g_ptr_array_free(bases, TRUE);
+}
+
+static void scan_unthemed(ThemeBuild *build) {
+    const IconDir info = {.scale = 1, .type = ICON_DIR_UNTHEMED};
+    GPtrArray *bases = icon_base_dirs();
+    GPtrArray *pixmaps = pixmap_dirs();
+    for (guint i = 0; i < bases->len; i++)
+        add_dir(build, g_ptr_array_index(bases, i), info);
+    for (guint i = 0; i < pixmaps->len; i++)
+        add_dir(build, g_ptr_array_index(pixmaps, i), info);
+    g_ptr_array_free(pixmaps, TRUE);
+    g_ptr_array_free(bases, TRUE);
+}
+
+static void free_file_list(gpointer data) {
+    g_array_free((GArray *)data, TRUE);
+}
+
+static gint compare_strings(gconstpointer a, gconstpointer b) {
+    return strcmp(*(const char *const *)a, *(const char *const *)b);
+}
+
+static GByteArray *build_index(const char *name) {
+    TRACE_SCOPE("ui_icon_theme_build");
+    ThemeBuild build = {
+        .stamps = g_array_new(FALSE, FALSE, sizeof(IconStamp)),
+        .dirs = g_array_new(FALSE, FALSE, sizeof(IconDir)),
+        .names = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, free_file_list),
+        .strings = g_byte_array_new()
+    };
+    g_byte_array_append(build.strings, (const guint8 *)"", 1);
+
+    guint32 inherits = 0;
+    if (name)
+        scan_theme(&build, name, &inherits);
+    else
+        scan_unthemed(&build);
+
+    guint name_count = g_hash_table_size(build.names);
+    const char **sorted = (const char **)g_hash_table_get_keys_as_array(build.names, NULL);
+    qsort(sorted, name_count, sizeof(*sorted), compare_strings);
+
+    guint32 bucket_count = ICON_THEME_MIN_BUCKETS;
+    while (bucket_count < name_count * 2)
+        bucket_count <<= 1;
+
+    guint32 *buckets = g_new0(guint32, bucket_count);
+    GArray *names = g_array_sized_new(FALSE, FALSE, sizeof(IconName), name_count);
+    GArray *files = g_array_new(FALSE, FALSE, sizeof(guint32));
+    for (guint i = 0; i < name_count; i++) {
+        const GArray *dirs = g_hash_table_lookup(build.names, sorted[i]);
+        IconName entry = {.name = add_string(&build, sorted[i]), .first_file = files->len, .file_count = dirs->len};
+        g_array_append_vals(files, dirs->data, dirs->len);
+        g_array_append_val(names, entry);
+
+        guint32 slot = hash_name(sorted[i]) & (bucket_count - 1);
+        while (buckets[slot])
+            slot = (slot + 1) & (bucket_count - 1);
+        buckets[slot] = i + 1;
+    }
+
+    IconThemeHeader header = {
+        .version = ICON_THEME_VERSION,
+        .stamp_count = build.stamps->len,
+        .dir_count = build.dirs->len,
+        .name_count = name_count,
+        .file_count = files->len,
+        .bucket_count = bucket_count,
+        .strings_size = build.strings->len,
+        .inherits = inherits
+    };
+    memcpy(header.magic, ICON_THEME_MAGIC, sizeof(header.magic));
+
+    GByteArray *blob = g_byte_array_new();
+    g_byte_array_append(blob, (const guint8 *)&header, sizeof(header));
+    g_byte_array_append(blob, (const guint8 *)build.stamps->data, build.stamps->len * sizeof(IconStamp));
+    g_byte_array_append(blob, (const guint8 *)build.dirs->data, build.dirs->len * sizeof(IconDir));
+    g_byte_array_append(blob, (const guint8 *)names->data, names->len * sizeof(IconName));
+    g_byte_array_append(blob, (const guint8 *)files->data, files->len * sizeof(guint32));
+    g_byte_array_append(blob, (const guint8 *)buckets, bucket_count * sizeof(guint32));
+    g_byte_array_append(blob, build.strings->data, build.strings->len);
+
+    g_free(sorted);
+    g_free(buckets);
+    g_array_free(names, TRUE);
+    g_array_free(files, TRUE);
+    g_array_free(build.stamps, TRUE);
+    g_array_free(build.dirs, TRUE);
+    g_hash_table_destroy(build.names);
+    g_byte_array_free(build.strings, TRUE);
+    return blob;
+}
+
+static gboolean attach(ThemeIndex *index, const guint8 *base, gsize length) {
+    if (!base || length < sizeof(IconThemeHeader))
+        return FALSE;
+
+    IconThemeHeader header;
+    memcpy(&header, base, sizeof(header));
+    gsize expected = sizeof(IconThemeHeader) + (gsize)header.stamp_count * sizeof(IconStamp) +
+                     (gsize)header.dir_count * sizeof(IconDir) + (gsize)header.name_count * sizeof(IconName) +
+                     ((gsize)header.file_count + header.bucket_count) * sizeof(guint32) + header.strings_size;
+    if (memcmp(header.magic, ICON_THEME_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != ICON_THEME_VERSION ||
+        header.bucket_count < ICON_THEME_MIN_BUCKETS ||
+        (header.bucket_count & (header.bucket_count - 1)) != 0 ||
+        header.bucket_count <= header.name_count ||
+        header.strings_size == 0 ||
+        header.inherits >= header.strings_size ||
+        expected != length ||
+        base[length - 1] != '\0')
+        return FALSE;
+
+    index->base = base;
+    index->header = header;
+
+    const IconStamp *stamps = index_stamps(index);
+    for (guint32 i = 0; i < header.stamp_count; i++) {
+        if (stamps[i].path >= header.strings_size)
+            return FALSE;
+    }
+
+    const IconDir *dirs = index_dirs(index);
+    for (guint32 i = 0; i < header.dir_count; i++) {
+        if (dirs[i].path >= header.strings_size)
+            return FALSE;
+    }
+
+    const IconName *names = index_names(index);
+    for (guint32 i = 0; i < header.name_count; i++) {
+        if (names[i].name >= header.strings_size || names[i].first_file > header.file_count ||
+            names[i].file_count > header.file_count - names[i].first_file)
+            return FALSE;
+    }
+
+    const guint32 *files = index_files(index);
+    for (guint32 i = 0; i < header.file_count; i++) {
+        if (files[i] >= header.dir_count)
+            return FALSE;
+    }
+
+    const guint32 *buckets = index_buckets(index);
+    for (guint32 i = 0; i < header.bucket_count; i++) {
+        if (buckets[i] > header.name_count)
+            return FALSE;
+    }
+    return TRUE;
+}
+
+static gboolean index_current(const ThemeIndex *index) {
+    if (!index->base)
+        return FALSE;
+
+    const IconStamp *stamps = index_stamps(index);
+    const char *strings = index_strings(index);
+    for (guint32 i = 0; i < index->header.stamp_count; i++) {
+        if (path_mtime(strings + stamps[i].path) != stamps[i].mtime)
+            return FALSE;
+    }
+    return TRUE;
+}
+
+static void free_theme_index(gpointer data) {
+    ThemeIndex *index = (ThemeIndex *)data;
+    if (!index)
+        return;
+    if (index->mapped)
+        g_mapped_file_unref(index->mapped);
+    if (index->blob)
+        g_byte_array_free(index->blob, TRUE);
+    g_free(index->name);
+    g_free(index);
+}
+
+static ThemeIndex *open_index(const char *name, const char *path) {
+    ThemeIndex *index = g_new0(ThemeIndex, 1);
+    index->name = g_strdup(name);
+
+    index->mapped = g_mapped_file_new(path, FALSE, NULL);
+    if (index->mapped &&
+        attach(index, (const guint8 *)g_mapped_file_get_contents(index->mapped), g_mapped_file_get_length(index->mapped)) &&
+        index_current(index))
+        return index;
+
+    g_clear_pointer(&index->mapped, g_mapped_file_unref);
+    index->base = NULL;
+    index->blob = build_index(name);
+    gchar *dir_path = g_path_get_dirname(path);
+    g_mkdir_with_parents(dir_path, 0700);
+    g_free(dir_path);
+    g_file_set_contents(path, (const gchar *)index->blob->data, (gssize)index->blob->len, NULL);
+
+    if (!attach(index, index->blob->data, index->blob->len)) {
+        free_theme_index(index);
+        return NULL;
+    }
+    return index;
+}
+
+static ThemeIndex *take_index(GPtrArray *previous, const char *name, gboolean *changed) {
+    for (guint i = 0; previous && i < previous->len; i++) {
+        ThemeIndex *index = g_ptr_array_index(previous, i);
+        if (!index || g_strcmp0(index->name, name) != 0)
+            continue;
+
+        if (index_current(index)) {
+            g_ptr_array_index(previous, i) = NULL;
+            return index;
+        }
+        break;
+    }
+
+    *changed = TRUE;
+    gchar *path = index_path(name);
+    ThemeIndex *index = open_index(name, path);
+    g_free(path);
+    return index;
+}
+
+static gboolean in_chain(const GPtrArray *chain, const char *name) {
+    for (guint i = 0; i < chain->len; i++) {
+        if (g_strcmp0(((const ThemeIndex *)g_ptr_array_index(chain, i))->name, name) == 0)
+            return TRUE;
+    }
+    return FALSE;
+}
+
+static void add_theme(GPtrArray *chain, GPtrArray *previous, const char *name, gboolean *changed) {
+    if (!valid_theme_name(name) || in_chain(chain, name) || chain->len >= ICON_THEME_MAX_THEMES)
+        return;
+
+    ThemeIndex *index = take_index(previous, name, changed);
+    if (!index)
+        return;
+    g_ptr_array_add(chain, index);
+
+    const char *inherits = index_strings(index) + index->header.inherits;
+    if (!*inherits)
+        return;
+
+    gchar **parents = g_strsplit(inherits, ",", -1);
+    for (guint i = 0; parents[i]; i++)
+        add_theme(chain, previous, g_strstrip(parents[i]), changed);
+    g_strfreev(parents);
+}
+
+char *ui_icon_theme_default_name(void) {
+    const char *const settings[] = {"gtk-4.0", "gtk-3.0"};
+    for (guint i = 0; i < G_N_ELEMENTS(settings); i++) {
+        gchar *path = g_build_filename(g_get_user_config_dir(), settings[i], "settings.ini", NULL);
+        GKeyFile *keys = g_key_file_new();
+        gchar *name = NULL;
+        if (g_key_file_load_from_file(keys, path, G_KEY_FILE_NONE, NULL))
+            name = g_key_file_get_string(keys, "Settings", "gtk-icon-theme-name", NULL);
+        g_key_file_free(keys);
+        g_free(path);
+
+        if (name && valid_theme_name(g_strstrip(name)))
+            return name;
+        g_free(name);
+    }
+    return g_strdup(ICON_THEME_FALLBACK);
+}
+
+void ui_icon_theme_init(UIIconTheme *theme) {
+    if (!theme)
+        return;
+    memset(theme, 0, sizeof(*theme));
+}
+
+gboolean ui_icon_theme_load(UIIconTheme *theme, const char *name) {
+    if (!theme)
+        return FALSE;
+
+    TRACE_SCOPE("ui_icon_theme_load");
+
+    GPtrArray *previous = theme->chain;
+    GPtrArray *chain = g_ptr_array_new_with_free_func(free_theme_index);
+    gboolean changed = !previous || g_strcmp0(theme->name, name) != 0;
+
+    add_theme(chain, previous, name, &changed);
+    add_theme(chain, previous, ICON_THEME_FALLBACK, &changed);
+    ThemeIndex *unthemed = take_index(previous, NULL, &changed);
+    if (unthemed)
+        g_ptr_array_add(chain, unthemed);
+
+    if (previous) {
+        for (guint i = 0; i < previous->len; i++)
+            changed = changed || g_ptr_array_index(previous, i) != NULL;
+        g_ptr_array_free(previous, TRUE);
+    }
+
+    g_free(theme->name);
+    theme->name = g_strdup(name);
+    theme->chain = chain;
+    return changed;
+}
+
+void ui_icon_theme_free(UIIconTheme *theme) {
+    if (!theme)
+        return;
+
+    if (theme->chain)
+        g_ptr_array_free(theme->chain, TRUE);
+    g_free(theme->name);
+    memset(theme, 0, sizeof(*theme));
+}
+
+static gint find_name(const ThemeIndex *index, const char *icon) {
+    const guint32 *buckets = index_buckets(index);
+    const IconName *names = index_names(index);
+    const char *strings = index_strings(index);
+    guint32 mask = index->header.bucket_count - 1;
+    for (guint32 slot = hash_name(icon) & mask, probes = 0; buckets[slot] && probes < index->header.bucket_count;
+         slot = (slot + 1) & mask, probes++) {
+        guint32 position = buckets[slot] - 1;
+        if (strcmp(strings + names[position].name, icon) == 0)
+            return (gint)position;
+    }
+    return -1;
+}
+
+static gint size_distance(const IconDir *dir, gint size) {
+    gint scaled = size;
+    switch (dir->type) {
+    case ICON_DIR_FIXED:
+        return ABS(dir->size * dir->scale - scaled);
+    case ICON_DIR_SCALABLE:
+        if (scaled < dir->min_size * dir->scale)
+            return dir->min_size * dir->scale - scaled;
+        if (scaled > dir->max_size * dir->scale)
+            return scaled - dir->max_size * dir->scale;
+        return 0;
+    case ICON_DIR_THRESHOLD:
+        if (scaled < (dir->size - dir->threshold) * dir->scale)
+            return dir->min_size * dir->scale - scaled;
+        if (scaled > (dir->size + dir->threshold) * dir->scale)
+            return scaled - dir->max_size * dir->scale;
+        return 0;
+    case ICON_DIR_UNTHEMED:
+        break;
+    }
+    return 0;
+}
+
+static gboolean size_matches(const IconDir *dir, gint size) {
+    if (dir->type == ICON_DIR_UNTHEMED)
+        return TRUE;
+    return dir->scale == 1 && size_distance(dir, size) == 0;
+}
+
+gchar *ui_icon_theme_lookup(const UIIconTheme *theme, const char *icon, gint size) {
+    if (!theme || !theme->chain || !icon || !*icon || strchr(icon, '/'))
+        return NULL;
+
+    for (guint t = 0; t < theme->chain->len; t++) {
+        const ThemeIndex *index = g_ptr_array_index(theme->chain, t);
+        gint position = find_name(index, icon);
+        if (position < 0)
+            continue;
+
+        const IconName *name = &index_names(index)[position];
+        const guint32 *files = index_files(index) + name->first_file;
+        const IconDir *dirs = index_dirs(index);
+        const IconDir *best = NULL;
+        gint best_distance = G_MAXINT;
+        for (guint32 i = 0; i < name->file_count; i++) {
+            const IconDir *dir = &dirs[files[i]];
+            if (size_matches(dir, size)) {
+                best = dir;
+                break;
+            }
+            gint distance = size_distance(dir, size);
+            if (distance < best_distance) {
+                best = dir;
+                best_distance = distance;
+            }
+        }
+        if (best) {
+            gchar *file_name = g_strconcat(icon, ICON_THEME_EXTENSION, NULL);
+            gchar *path = g_build_filename(index_strings(index) + best->path, file_name, NULL);
+            g_free(file_name);
+            return path;
+        }
+    }
+    return NULL;
+}
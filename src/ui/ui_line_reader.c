@@ -0,0 +1,159 @@
+#include "ui/ui_line_reader.h"
+#include "Trace.h"
+#include <errno.h>
+#include <poll.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#define LINE_READER_BUFFER_SIZE (64 * 1024)
+
+static void drain_wakeup(int fd) {
+    uint64_t count = 0;
+    while (fd >= 0 && read(fd, &count, sizeof(count)) == (ssize_t)sizeof(count))
+        ;
+}
+
+static void signal_wakeup(int fd) {
+    uint64_t one = 1;
+    if (fd >= 0 && write(fd, &one, sizeof(one)) != (ssize_t)sizeof(one) && errno != EAGAIN)
+        g_printerr("waycast: could not signal line reader\n");
+}
+
+static bool ingest(UILineStore *store, GByteArray *partial, const char *data, gsize length) {
+    const char *start = data;
+    const char *end = data + length;
+    while (start < end) {
+        const char *newline = memchr(start, '\n', (gsize)(end - start));
+        if (!newline) {
+            g_byte_array_append(partial, (const guint8 *)start, (guint)(end - start));
+            return true;
+        }
+
+        bool stored;
+        if (partial->len > 0) {
+            g_byte_array_append(partial, (const guint8 *)start, (guint)(newline - start));
+            stored = ui_line_store_append(store, (const char *)partial->data, partial->len);
+            g_byte_array_set_size(partial, 0);
+        } else {
+            stored = ui_line_store_append(store, start, (gsize)(newline - start));
+        }
+        if (!stored)
+            return false;
+        start = newline + 1;
+    }
+    return true;
+}
+
+static gpointer reader_thread(gpointer user_data) {
+    UILineReader *reader = (UILineReader *)user_data;
+    GByteArray *partial = g_byte_array_new();
+    char *buffer = g_malloc(LINE_READER_BUFFER_SIZE);
+    struct pollfd fds[2] = {
+        {.fd = reader->input, .events = POLLIN},
+        {.fd = reader->quit_fd, .events = POLLIN}
+    };
+
+    bool open = true;
+    while (open) {
+        if (poll(fds, reader->quit_fd >= 0 ? 2 : 1, -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        if (fds[1].revents & POLLIN)
+            break;
+
+        ssize_t length = read(reader->input, buffer, LINE_READER_BUFFER_SIZE);
+        if (length < 0 && (errno == EINTR || errno == EAGAIN))
+            continue;
+        if (length <= 0)
+            break;
+
+        open = ingest(reader->store, partial, buffer, (gsize)length);
+        ui_line_store_publish(reader->store);
+        signal_wakeup(reader->fd);
+    }
+
+    if (open && partial->len > 0) {
+        ui_line_store_append(reader->store, (const char *)partial->data, partial->len);
+        ui_line_store_publish(reader->store);
+    }
+    g_free(buffer);
+    g_byte_array_free(partial, TRUE);
+
+    g_atomic_int_set(&reader->done, 1);
+    signal_wakeup(reader->fd);
+    return NULL;
+}
+
+void ui_line_reader_init(UILineReader *reader) {
+    if (!reader)
+        return;
+
+    memset(reader, 0, sizeof(*reader));
+    reader->input = -1;
+    reader->fd = -1;
+    reader->quit_fd = -1;
+    reader->finished = true;
+}
+
+void ui_line_reader_start(UILineReader *reader, UILineStore *store, int input) {
+    if (!reader || !store || input < 0)
+        return;
+
+    ui_line_reader_init(reader);
+    reader->store = store;
+    reader->input = input;
+    reader->fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    reader->quit_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    reader->finished = false;
+    reader->thread = g_thread_new("waycast-lines", reader_thread, reader);
+}
+
+void ui_line_reader_free(UILineReader *reader) {
+    if (!reader)
+        return;
+
+    if (reader->thread) {
+        signal_wakeup(reader->quit_fd);
+        g_thread_join(reader->thread);
+    }
+    reader->thread = NULL;
+    if (reader->fd >= 0)
+        close(reader->fd);
+    if (reader->quit_fd >= 0)
+        close(reader->quit_fd);
+    reader->fd = -1;
+    reader->quit_fd = -1;
+    reader->finished = true;
+}
+
+int ui_line_reader_fd(const UILineReader *reader) {
+    if (!reader || reader->finished)
+        return -1;
+    return reader->fd;
+}
+
+bool ui_line_reader_finished(const UILineReader *reader) {
+    return !reader || reader->finished;
+}
+
+bool ui_line_reader_poll(UILineReader *reader) {
+    if (ui_line_reader_finished(reader))
+        return false;
+
+    drain_wakeup(reader->fd);
+    if (g_atomic_int_get(&reader->done)) {
+        g_thread_join(reader->thread);
+        reader->thread = NULL;
+        reader->finished = true;
+        trace_instant("lines_ready");
+    }
+
+    guint count = ui_line_store_count(reader->store);
+    bool grew = count != reader->seen;
+    reader->seen = count;
+    return grew;
+}
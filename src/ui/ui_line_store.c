@@ -0,0 +1,133 @@
+#include "ui/ui_line_store.h"
+#include "ui/ui_fuzzy.h"
+#include <string.h>
+
+#define LINE_STORE_CHUNK_SIZE (1u << 20)
+#define LINE_STORE_FOLD_MAX 1024
+
+void ui_line_store_init(UILineStore *store) {
+    if (!store)
+        return;
+
+    memset(store, 0, sizeof(*store));
+    store->blocks = g_new0(UILineBlock *, UI_LINE_STORE_MAX_BLOCKS);
+    store->chunks = g_ptr_array_new_with_free_func(g_free);
+}
+
+void ui_line_store_clear(UILineStore *store) {
+    if (!store || !store->blocks)
+        return;
+
+    for (guint b = 0; b < UI_LINE_STORE_MAX_BLOCKS && store->blocks[b]; b++)
+        g_free(store->blocks[b]);
+    g_free(store->blocks);
+    g_ptr_array_free(store->chunks, TRUE);
+    memset(store, 0, sizeof(*store));
+}
+
+static char *fold_line(const char *text, char *buffer) {
+    gsize length = 0;
+    for (; text[length] && length + 1 < LINE_STORE_FOLD_MAX; length++) {
+        guchar c = (guchar)text[length];
+        if (c >= 0x80)
+            break;
+        buffer[length] = (char)(c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c);
+    }
+    if (!text[length]) {
+        buffer[length] = '\0';
+        return buffer;
+    }
+    return g_utf8_casefold(text, -1);
+}
+
+static void free_folded(char *folded, char *buffer) {
+    if (folded != buffer)
+        g_free(folded);
+}
+
+static char *reserve(UILineStore *store, gsize size) {
+    if (!store->chunk || store->chunk_used + size > store->chunk_size) {
+        store->chunk_size = MAX(size, (gsize)LINE_STORE_CHUNK_SIZE);
+        store->chunk = g_malloc(store->chunk_size);
+        store->chunk_used = 0;
+        g_ptr_array_add(store->chunks, store->chunk);
+    }
+
+    char *text = store->chunk + store->chunk_used;
+    store->chunk_used += size;
+    return text;
+}
+
+gboolean ui_line_store_append(UILineStore *store, const char *text, gsize length) {
+    if (!store || !store->blocks || !text)
+        return FALSE;
+
+    guint block = store->count / UI_LINE_STORE_BLOCK;
+    guint slot = store->count % UI_LINE_STORE_BLOCK;
+    if (block >= UI_LINE_STORE_MAX_BLOCKS)
+        return FALSE;
+    if (!store->blocks[block])
+        store->blocks[block] = g_new(UILineBlock, 1);
+
+    char *line = reserve(store, length + 1);
+    memcpy(line, text, length);
+    line[length] = '\0';
+
+    char buffer[LINE_STORE_FOLD_MAX];
+    char *folded = fold_line(line, buffer);
+    store->blocks[block]->text[slot] = line;
+    store->blocks[block]->masks[slot] = ui_fuzzy_char_mask(folded);
+    free_folded(folded, buffer);
+    store->count++;
+    return TRUE;
+}
+
+void ui_line_store_publish(UILineStore *store) {
+    if (!store)
+        return;
+    g_atomic_int_set(&store->published, (gint)store->count);
+}
+
+guint ui_line_store_count(const UILineStore *store) {
+    if (!store || !store->blocks)
+        return 0;
+    return (guint)g_atomic_int_get(&store->published);
+}
+
+const char *ui_line_store_get(const UILineStore *store, guint index) {
+    if (index >= ui_line_store_count(store))
+        return NULL;
+    return store->blocks[index / UI_LINE_STORE_BLOCK]->text[index % UI_LINE_STORE_BLOCK];
+}
+
+gboolean ui_line_store_search(const UILineStore *store,
+                              guint count,
+                              const char *folded_query,
+                              UILineStoreMatch match,
+                              UILineStoreCancelled cancelled,
+                              gpointer user_data) {
+    if (!store || !store->blocks || !folded_query || !*folded_query || !match)
+        return TRUE;
+
+    count = MIN(count, ui_line_store_count(store));
+    guint64 query_mask = ui_fuzzy_char_mask(folded_query);
+    char buffer[LINE_STORE_FOLD_MAX];
+    guint candidates[UI_LINE_STORE_BLOCK];
+
+    for (guint first = 0; first < count; first += UI_LINE_STORE_BLOCK) {
+        if (cancelled && cancelled(user_data))
+            return FALSE;
+
+        const UILineBlock *block = store->blocks[first / UI_LINE_STORE_BLOCK];
+        guint found = ui_fuzzy_prefilter(block->masks, MIN(count - first, (guint)UI_LINE_STORE_BLOCK),
+                                         query_mask, candidates);
+        for (guint i = 0; i < found; i++) {
+            char *folded = fold_line(block->text[candidates[i]], buffer);
+            gint score = ui_fuzzy_score(folded, folded_query);
+            free_folded(folded, buffer);
+            if (score != UI_FUZZY_NO_MATCH)
+                match(first + candidates[i], score, user_data);
+        }
+    }
+    return TRUE;
+}
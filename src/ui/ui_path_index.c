@@ -0,0 +1,419 @@
+#define _GNU_SOURCE
+#include "ui/ui_path_index.h"
+#include "Trace.h"
+#include "ui/ui_app_exec.h"
+#include <dirent.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define PATH_INDEX_MAGIC "WPATHIX1"
+#define PATH_INDEX_VERSION 1
+#define PATH_INDEX_MIN_BUCKETS 16
+#define PATH_INDEX_MAX_NAMES (1u << 20)
+
+typedef struct {
+    char magic[8];
+    guint32 version;
+    guint32 dir_count;
+    guint32 name_count;
+    guint32 bucket_count;
+    guint32 strings_size;
+    guint32 reserved;
+} PathIndexHeader;
+
+typedef struct {
+    guint32 path;
+    guint32 reserved;
+    gint64 mtime;
+} PathDir;
+
+typedef struct {
+    guint32 name;
+    guint32 dir;
+} PathName;
+
+typedef struct {
+    gchar *path;
+    gint64 mtime;
+} SearchDir;
+
+static const PathDir *index_dirs(const UIPathIndex *index) {
+    return (const PathDir *)(const void *)(index->base + sizeof(PathIndexHeader));
+}
+
+static const PathName *index_names(const UIPathIndex *index) {
+    return (const PathName *)(const void *)(index_dirs(index) + index->dir_count);
+}
+
+static const guint32 *index_buckets(const UIPathIndex *index) {
+    return (const guint32 *)(const void *)(index_names(index) + index->name_count);
+}
+
+static const char *index_strings(const UIPathIndex *index) {
+    return (const char *)(index_buckets(index) + index->bucket_count);
+}
+
+static guint32 hash_name(const char *name) {
+    guint32 hash = 2166136261u;
+    for (const guchar *p = (const guchar *)name; *p; p++) {
+        hash ^= *p;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static gint64 dir_mtime(const char *path) {
+    struct stat st;
+    if (stat(path, &st) != 0 || !S_ISDIR(st.st_mode))
+        return -1;
+    return (gint64)st.st_mtim.tv_sec * G_GINT64_CONSTANT(1000000000) + st.st_mtim.tv_nsec;
+}
+
+static void free_search_dir(gpointer data) {
+    SearchDir *dir = (SearchDir *)data;
+    g_free(dir->path);
+    g_free(dir);
+}
+
+static GPtrArray *search_dirs(void) {
+    GPtrArray *dirs = g_ptr_array_new_with_free_func(free_search_dir);
+    const char *env = g_getenv("PATH");
+    if (!env)
+        return dirs;
+
+    gchar **parts = g_strsplit(env, G_SEARCHPATH_SEPARATOR_S, -1);
+    for (guint i = 0; parts[i]; i++) {
+        if (!g_path_is_absolute(parts[i]))
+            continue;
+
+        gboolean seen = FALSE;
+        for (guint j = 0; j < dirs->len && !seen; j++)
+            seen = strcmp(((SearchDir *)g_ptr_array_index(dirs, j))->path, parts[i]) == 0;
+        if (seen)
+            continue;
+
+        SearchDir *dir = g_new0(SearchDir, 1);
+        dir->path = g_strdup(parts[i]);
+        dir->mtime = dir_mtime(dir->path);
+        g_ptr_array_add(dirs, dir);
+    }
+    g_strfreev(parts);
+    return dirs;
+}
+
+static gboolean index_matches(const UIPathIndex *index, const GPtrArray *dirs) {
+    if (!index->base || index->dir_count != dirs->len)
+        return FALSE;
+
+    const PathDir *stored = index_dirs(index);
+    const char *strings = index_strings(index);
+    for (guint i = 0; i < dirs->len; i++) {
+        const SearchDir *dir = g_ptr_array_index(dirs, i);
+        if (stored[i].mtime != dir->mtime || strcmp(strings + stored[i].path, dir->path) != 0)
+            return FALSE;
+    }
+    return TRUE;
+}
+
+static gboolean attach(UIPathIndex *index, const guint8 *base, gsize length) {
+    if (!base || length < sizeof(PathIndexHeader))
+        return FALSE;
+
+    PathIndexHeader header;
+    memcpy(&header, base, sizeof(header));
+    gsize expected = sizeof(PathIndexHeader) + (gsize)header.dir_count * sizeof(PathDir) +
+                     (gsize)header.name_count * sizeof(PathName) +
+                     (gsize)header.bucket_count * sizeof(guint32) + header.strings_size;
+    if (memcmp(header.magic, PATH_INDEX_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != PATH_INDEX_VERSION ||
+        header.name_count > PATH_INDEX_MAX_NAMES ||
+        header.bucket_count < PATH_INDEX_MIN_BUCKETS ||
+        (header.bucket_count & (header.bucket_count - 1)) != 0 ||
+        header.bucket_count <= header.name_count ||
+        header.strings_size == 0 ||
+        expected != length ||
+        base[length - 1] != '\0')
+        return FALSE;
+
+    index->base = base;
+    index->dir_count = header.dir_count;
+    index->name_count = header.name_count;
+    index->bucket_count = header.bucket_count;
+    index->strings_size = header.strings_size;
+
+    const PathDir *dirs = index_dirs(index);
+    for (guint32 i = 0; i < index->dir_count; i++) {
+        if (dirs[i].path >= index->strings_size)
+            return FALSE;
+    }
+
+    const PathName *names = index_names(index);
+    for (guint32 i = 0; i < index->name_count; i++) {
+        if (names[i].name >= index->strings_size || names[i].dir >= index->dir_count)
+            return FALSE;
+    }
+
+    const guint32 *buckets = index_buckets(index);
+    for (guint32 i = 0; i < index->bucket_count; i++) {
+        if (buckets[i] > index->name_count)
+            return FALSE;
+    }
+    return TRUE;
+}
+
+static gboolean open_file(UIPathIndex *index, const char *path) {
+    GMappedFile *mapped = g_mapped_file_new(path, FALSE, NULL);
+    if (!mapped)
+        return FALSE;
+
+    if (!attach(index, (const guint8 *)g_mapped_file_get_contents(mapped), g_mapped_file_get_length(mapped))) {
+        g_mapped_file_unref(mapped);
+        ui_path_index_close(index);
+        return FALSE;
+    }
+    index->mapped = mapped;
+    return TRUE;
+}
+
+static gboolean executable_name(const char *name) {
+    return strcmp(name, ".") != 0 && strcmp(name, "..") != 0 && !strchr(name, UI_APP_EXEC_SEPARATOR[0]);
+}
+
+static void list_executables(int dir_fd, guint dir, GHashTable *seen, GArray *names, GPtrArray *owned) {
+    DIR *listing = fdopendir(dir_fd);
+    if (!listing) {
+        close(dir_fd);
+        return;
+    }
+
+    struct dirent *ent;
+    while ((ent = readdir(listing)) && names->len < PATH_INDEX_MAX_NAMES) {
+        if (ent->d_type == DT_DIR || !executable_name(ent->d_name) || g_hash_table_contains(seen, ent->d_name))
+            continue;
+
+        struct stat st;
+        if (fstatat(dirfd(listing), ent->d_name, &st, 0) != 0 || !S_ISREG(st.st_mode) ||
+            faccessat(dirfd(listing), ent->d_name, X_OK, 0) != 0)
+            continue;
+
+        gchar *name = g_strdup(ent->d_name);
+        g_ptr_array_add(owned, name);
+        g_hash_table_add(seen, name);
+        PathName entry = {.name = owned->len - 1, .dir = dir};
+        g_array_append_val(names, entry);
+    }
+    closedir(listing);
+}
+
+static gint compare_names(gconstpointer a, gconstpointer b, gpointer user_data) {
+    const GPtrArray *owned = (const GPtrArray *)user_data;
+    return strcmp(g_ptr_array_index(owned, ((const PathName *)a)->name),
+                  g_ptr_array_index(owned, ((const PathName *)b)->name));
+}
+
+static void append_string(GByteArray *strings, guint32 *offset, const char *text) {
+    *offset = strings->len;
+    g_byte_array_append(strings, (const guint8 *)text, (guint)strlen(text) + 1);
+}
+
+static GByteArray *build(const GPtrArray *dirs) {
+    TRACE_SCOPE("ui_path_index_build");
+    GHashTable *seen = g_hash_table_new(g_str_hash, g_str_equal);
+    GPtrArray *owned = g_ptr_array_new_with_free_func(g_free);
+    GArray *names = g_array_new(FALSE, FALSE, sizeof(PathName));
+
+    for (guint i = 0; i < dirs->len; i++) {
+        const SearchDir *dir = g_ptr_array_index(dirs, i);
+        int fd = open(dir->path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd >= 0)
+            list_executables(fd, i, seen, names, owned);
+    }
+    g_array_sort_with_data(names, compare_names, owned);
+
+    guint32 bucket_count = PATH_INDEX_MIN_BUCKETS;
+    while (bucket_count < names->len * 2)
+        bucket_count <<= 1;
+
+    GByteArray *strings = g_byte_array_new();
+    g_byte_array_append(strings, (const guint8 *)"", 1);
+    GArray *stored_dirs = g_array_sized_new(FALSE, TRUE, sizeof(PathDir), dirs->len);
+    for (guint i = 0; i < dirs->len; i++) {
+        const SearchDir *dir = g_ptr_array_index(dirs, i);
+        PathDir stored = {.mtime = dir->mtime};
+        append_string(strings, &stored.path, dir->path);
+        g_array_append_val(stored_dirs, stored);
+    }
+
+    guint32 *buckets = g_new0(guint32, bucket_count);
+    for (guint i = 0; i < names->len; i++) {
+        PathName *entry = &g_array_index(names, PathName, i);
+        const char *name = g_ptr_array_index(owned, entry->name);
+        guint32 slot = hash_name(name) & (bucket_count - 1);
+        while (buckets[slot])
+            slot = (slot + 1) & (bucket_count - 1);
+        buckets[slot] = i + 1;
+        append_string(strings, &entry->name, name);
+    }
+
+    PathIndexHeader header = {
+        .version = PATH_INDEX_VERSION,
+        .dir_count = dirs->len,
+        .name_count = names->len,
+        .bucket_count = bucket_count,
+        .strings_size = strings->len
+    };
+    memcpy(header.magic, PATH_INDEX_MAGIC, sizeof(header.magic));
+
+    GByteArray *blob = g_byte_array_new();
+    g_byte_array_append(blob, (const guint8 *)&header, sizeof(header));
+    g_byte_array_append(blob, (const guint8 *)stored_dirs->data, stored_dirs->len * sizeof(PathDir));
+    g_byte_array_append(blob, (const guint8 *)names->data, names->len * sizeof(PathName));
+    g_byte_array_append(blob, (const guint8 *)buckets, bucket_count * sizeof(guint32));
+    g_byte_array_append(blob, strings->data, strings->len);
+
+    g_free(buckets);
+    g_array_free(stored_dirs, TRUE);
+    g_byte_array_free(strings, TRUE);
+    g_array_free(names, TRUE);
+    g_hash_table_destroy(seen);
+    g_ptr_array_free(owned, TRUE);
+    return blob;
+}
+
+char *ui_path_index_default_path(void) {
+    return g_build_filename(g_get_user_cache_dir(), "waycast", "path.bin", NULL);
+}
+
+void ui_path_index_init(UIPathIndex *index) {
+    if (!index)
+        return;
+    memset(index, 0, sizeof(*index));
+}
+
+gboolean ui_path_index_valid(const UIPathIndex *index) {
+    if (!ui_path_index_ready(index))
+        return FALSE;
+
+    GPtrArray *dirs = search_dirs();
+    gboolean valid = index_matches(index, dirs);
+    g_ptr_array_free(dirs, TRUE);
+    return valid;
+}
+
+gboolean ui_path_index_load(UIPathIndex *index) {
+    if (!index)
+        return FALSE;
+
+    GPtrArray *dirs = search_dirs();
+    if (index_matches(index, dirs)) {
+        g_ptr_array_free(dirs, TRUE);
+        return TRUE;
+    }
+
+    ui_path_index_close(index);
+    gchar *path = ui_path_index_default_path();
+    if (!open_file(index, path) || !index_matches(index, dirs)) {
+        ui_path_index_close(index);
+        GByteArray *blob = build(dirs);
+        gchar *dir_path = g_path_get_dirname(path);
+        g_mkdir_with_parents(dir_path, 0700);
+        g_free(dir_path);
+        g_file_set_contents(path, (const gchar *)blob->data, (gssize)blob->len, NULL);
+
+        index->blob = blob;
+        if (!attach(index, blob->data, blob->len))
+            ui_path_index_close(index);
+    }
+    g_free(path);
+    g_ptr_array_free(dirs, TRUE);
+    return index->base != NULL;
+}
+
+void ui_path_index_close(UIPathIndex *index) {
+    if (!index)
+        return;
+    if (index->mapped)
+        g_mapped_file_unref(index->mapped);
+    if (index->blob)
+        g_byte_array_free(index->blob, TRUE);
+    memset(index, 0, sizeof(*index));
+}
+
+gboolean ui_path_index_ready(const UIPathIndex *index) {
+    return index && index->base;
+}
+
+guint ui_path_index_count(const UIPathIndex *index) {
+    if (!ui_path_index_ready(index))
+        return 0;
+    return index->name_count;
+}
+
+const char *ui_path_index_name(const UIPathIndex *index, guint position) {
+    if (!ui_path_index_ready(index) || position >= index->name_count)
+        return NULL;
+    return index_strings(index) + index_names(index)[position].name;
+}
+
+const char *ui_path_index_dir(const UIPathIndex *index, guint position) {
+    if (!ui_path_index_ready(index) || position >= index->name_count)
+        return NULL;
+    return index_strings(index) + index_dirs(index)[index_names(index)[position].dir].path;
+}
+
+gint ui_path_index_find(const UIPathIndex *index, const char *name) {
+    if (!ui_path_index_ready(index) || !name || !*name)
+        return -1;
+
+    const guint32 *buckets = index_buckets(index);
+    const PathName *names = index_names(index);
+    const char *strings = index_strings(index);
+    guint32 mask = index->bucket_count - 1;
+    for (guint32 slot = hash_name(name) & mask, probes = 0; buckets[slot] && probes < index->bucket_count;
+         slot = (slot + 1) & mask, probes++) {
+        guint32 position = buckets[slot] - 1;
+        if (strcmp(strings + names[position].name, name) == 0)
+            return (gint)position;
+    }
+    return -1;
+}
+
+gboolean ui_path_index_contains(const UIPathIndex *index, const char *name) {
+    return ui_path_index_find(index, name) >= 0;
+}
+
+guint ui_path_index_prefix_range(const UIPathIndex *index, const char *prefix, guint *first) {
+    if (first)
+        *first = 0;
+    if (!ui_path_index_ready(index) || !prefix)
+        return 0;
+
+    const PathName *names = index_names(index);
+    const char *strings = index_strings(index);
+    gsize length = strlen(prefix);
+    guint low = 0;
+    guint high = index->name_count;
+    while (low < high) {
+        guint mid = low + (high - low) / 2;
+        if (strcmp(strings + names[mid].name, prefix) < 0)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    guint start = low;
+    high = index->name_count;
+    while (low < high) {
+        guint mid = low + (high - low) / 2;
+        if (strncmp(strings + names[mid].name, prefix, length) == 0)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    if (first)
+        *first = start;
+    return low - start;
+}
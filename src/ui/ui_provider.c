@@ -0,0 +1,298 @@
+#include "ui/ui_provider.h"
+#include "ui/ui_app_exec.h"
+#include "ui/ui_calculator.h"
+#include <string.h>
+
+#define PROVIDER_STRING_CHUNK_SIZE 8192
+#define FILE_OPEN_COMMAND "xdg-open"
+#define FILE_ICON_DIR "folder"
+#define FILE_ICON_FILE "text-x-generic"
+#define COMMAND_ICON "utilities-terminal"
+
+void ui_provider_results_init(UIProviderResults *results) {
+    if (!results)
+        return;
+
+    results->items = g_array_sized_new(FALSE, FALSE, sizeof(UIAppResult), UI_APP_DATA_MAX_RESULTS);
+    results->strings = g_string_chunk_new(PROVIDER_STRING_CHUNK_SIZE);
+}
+
+void ui_provider_results_clear(UIProviderResults *results) {
+    if (!results)
+        return;
+
+    if (results->items)
+        g_array_free(results->items, TRUE);
+    g_clear_pointer(&results->strings, g_string_chunk_free);
+    results->items = NULL;
+}
+
+void ui_provider_results_reset(UIProviderResults *results) {
+    if (!results || !results->items)
+        return;
+
+    g_array_set_size(results->items, 0);
+    g_string_chunk_clear(results->strings);
+}
+
+void ui_provider_results_add_catalog(UIProviderResults *results, gint score, guint index) {
+    if (!results || !results->items)
+        return;
+
+    UIAppResult item = {.score = score, .index = index};
+    g_array_append_val(results->items, item);
+}
+
+static const char *copy_string(UIProviderResults *results, const char *text) {
+    return text ? g_string_chunk_insert(results->strings, text) : NULL;
+}
+
+void ui_provider_results_add(UIProviderResults *results, gint score, const App *app) {
+    if (!results || !results->items || !app)
+        return;
+
+    UIAppResult item = {
+        .score = score,
+        .index = UI_APP_RESULT_EXTERNAL,
+        .app = {
+            .id = copy_string(results, app->id),
+            .name = copy_string(results, app->name),
+            .exec = copy_string(results, app->exec),
+            .icon = copy_string(results, app->icon),
+            .path = copy_string(results, app->path),
+            .working_dir = copy_string(results, app->working_dir),
+            .terminal = app->terminal
+        }
+    };
+    g_array_append_val(results->items, item);
+}
+
+typedef struct {
+    UIAppSearch search;
+    GArray *matches;
+    GString *path;
+} CatalogState;
+
+static gpointer catalog_state_new(void) {
+    CatalogState *state = g_new0(CatalogState, 1);
+    ui_app_search_init(&state->search);
+    state->matches = g_array_sized_new(FALSE, FALSE, sizeof(UIAppMatch), UI_APP_DATA_MAX_RESULTS);
+    state->path = g_string_sized_new(256);
+    return state;
+}
+
+static void catalog_state_free(gpointer data) {
+    CatalogState *state = (CatalogState *)data;
+    if (!state)
+        return;
+
+    ui_app_search_clear(&state->search);
+    g_array_free(state->matches, TRUE);
+    g_string_free(state->path, TRUE);
+    g_free(state);
+}
+
+static gboolean apps_accepts(const char *query) {
+    return !ui_app_data_is_file_query(query) && !ui_app_data_is_command_query(query);
+}
+
+static guint apps_revision(const UIAppData *data) {
+    return data->revision;
+}
+
+static guint files_revision(const UIAppData *data) {
+    return data->files_revision;
+}
+
+static guint commands_revision(const UIAppData *data) {
+    return data->commands_revision;
+}
+
+static gboolean apps_search(const UIAppData *data,
+                            gpointer state,
+                            const char *query,
+                            UIProviderResults *results,
+                            UIAppSearchCancelled cancelled,
+                            gpointer user_data) {
+    CatalogState *apps = (CatalogState *)state;
+    if (!ui_app_data_search(data, &apps->search, query, apps->matches, cancelled, user_data))
+        return FALSE;
+
+    for (guint i = 0; i < apps->matches->len; i++) {
+        const UIAppMatch *match = &g_array_index(apps->matches, UIAppMatch, i);
+        ui_provider_results_add_catalog(results, match->score, match->index);
+    }
+    return TRUE;
+}
+
+static gboolean files_search(const UIAppData *data,
+                             gpointer state,
+                             const char *query,
+                             UIProviderResults *results,
+                             UIAppSearchCancelled cancelled,
+                             gpointer user_data) {
+    CatalogState *files = (CatalogState *)state;
+    if (!ui_app_data_search_files(data, query, files->matches, cancelled, user_data))
+        return FALSE;
+
+    for (guint i = 0; i < files->matches->len; i++) {
+        const UIAppMatch *match = &g_array_index(files->matches, UIAppMatch, i);
+        guint32 flags = 0;
+        if (!ui_file_db_entry(&data->files, match->index, files->path, &flags))
+            continue;
+
+        const char *slash = strrchr(files->path->str, '/');
+        gchar *exec = g_strconcat(FILE_OPEN_COMMAND, UI_APP_EXEC_SEPARATOR, files->path->str, NULL);
+        App app = {
+            .name = slash && slash[1] ? slash + 1 : files->path->str,
+            .exec = exec,
+            .icon = (flags & UI_FILE_DB_ENTRY_DIR) ? FILE_ICON_DIR : FILE_ICON_FILE,
+            .path = files->path->str
+        };
+        ui_provider_results_add(results, match->score, &app);
+        g_free(exec);
+    }
+    return TRUE;
+}
+
+static gchar *command_arguments(const char *query, const char **rest) {
+    const char *line = query + 1;
+    while (g_ascii_isspace(*line))
+        line++;
+    while (*line && !g_ascii_isspace(*line))
+        line++;
+    *rest = line;
+
+    gchar **argv = NULL;
+    if (!g_shell_parse_argv(query + 1, NULL, &argv, NULL))
+        return g_strdup("");
+
+    GString *arguments = g_string_new(NULL);
+    for (guint i = 1; argv[i]; i++) {
+        g_string_append(arguments, UI_APP_EXEC_SEPARATOR);
+        g_string_append(arguments, argv[i]);
+    }
+    g_strfreev(argv);
+    return g_string_free(arguments, FALSE);
+}
+
+static gboolean commands_search(const UIAppData *data,
+                                gpointer state,
+                                const char *query,
+                                UIProviderResults *results,
+                                UIAppSearchCancelled cancelled,
+                                gpointer user_data) {
+    CatalogState *commands = (CatalogState *)state;
+    if (!ui_app_data_search_commands(data, query, commands->matches, cancelled, user_data))
+        return FALSE;
+    if (commands->matches->len == 0)
+        return TRUE;
+
+    const char *rest = NULL;
+    gchar *arguments = command_arguments(query, &rest);
+    for (guint i = 0; i < commands->matches->len; i++) {
+        const UIAppMatch *match = &g_array_index(commands->matches, UIAppMatch, i);
+        const char *command = ui_path_index_name(&data->commands, match->index);
+        g_string_assign(commands->path, command);
+        g_string_append(commands->path, rest);
+
+        gchar *exec = g_strconcat(command, arguments, NULL);
+        App app = {
+            .name = commands->path->str,
+            .exec = exec,
+            .icon = COMMAND_ICON
+        };
+        ui_provider_results_add(results, match->score, &app);
+        g_free(exec);
+    }
+    g_free(arguments);
+    return TRUE;
+}
+
+static gboolean lines_accepts(const char *query) {
+    (void)query;
+    return TRUE;
+}
+
+static gboolean lines_search(const UIAppData *data,
+                             gpointer state,
+                             const char *query,
+                             UIProviderResults *results,
+                             UIAppSearchCancelled cancelled,
+                             gpointer user_data) {
+    CatalogState *lines = (CatalogState *)state;
+    if (!ui_app_data_search_lines(data, query, lines->matches, cancelled, user_data))
+        return FALSE;
+
+    for (guint i = 0; i < lines->matches->len; i++) {
+        const UIAppMatch *match = &g_array_index(lines->matches, UIAppMatch, i);
+        App app = {.name = ui_line_store_get(&data->lines, match->index)};
+        ui_provider_results_add(results, match->score, &app);
+    }
+    return TRUE;
+}
+
+static const UIProvider apps_provider = {
+    .name = "apps",
+    .budget_us = 16 * G_TIME_SPAN_MILLISECOND,
+    .timeout_us = 250 * G_TIME_SPAN_MILLISECOND,
+    .catalog = TRUE,
+    .revision = apps_revision,
+    .accepts = apps_accepts,
+    .state_new = catalog_state_new,
+    .state_free = catalog_state_free,
+    .search = apps_search
+};
+
+static const UIProvider files_provider = {
+    .name = "files",
+    .budget_us = 40 * G_TIME_SPAN_MILLISECOND,
+    .timeout_us = G_TIME_SPAN_SECOND,
+    .catalog = TRUE,
+    .revision = files_revision,
+    .accepts = ui_app_data_is_file_query,
+    .state_new = catalog_state_new,
+    .state_free = catalog_state_free,
+    .search = files_search
+};
+
+static const UIProvider commands_provider = {
+    .name = "commands",
+    .budget_us = 8 * G_TIME_SPAN_MILLISECOND,
+    .timeout_us = 100 * G_TIME_SPAN_MILLISECOND,
+    .catalog = TRUE,
+    .revision = commands_revision,
+    .accepts = ui_app_data_is_command_query,
+    .state_new = catalog_state_new,
+    .state_free = catalog_state_free,
+    .search = commands_search
+};
+
+static const UIProvider lines_provider = {
+    .name = "lines",
+    .budget_us = 16 * G_TIME_SPAN_MILLISECOND,
+    .timeout_us = 0,
+    .catalog = FALSE,
+    .accepts = lines_accepts,
+    .state_new = catalog_state_new,
+    .state_free = catalog_state_free,
+    .search = lines_search
+};
+
+const UIProvider *ui_provider_get(UIProviderKind kind) {
+    switch (kind) {
+    case UI_PROVIDER_APPS:
+        return &apps_provider;
+    case UI_PROVIDER_FILES:
+        return &files_provider;
+    case UI_PROVIDER_CALCULATOR:
+        return &ui_provider_calculator;
+    case UI_PROVIDER_COMMANDS:
+        return &commands_provider;
+    case UI_PROVIDER_LINES:
+        return &lines_provider;
+    case UI_PROVIDER_COUNT:
+        break;
+    }
+    return NULL;
+}
@@ -57,8 +57,9 @@ bool ui_search_bar_handle_input(UISearchBar *bar, bool *should_close) {
 
 void ui_search_bar_draw(const UISearchBar *bar,
                         Rectangle rect,
-                        Font font,
-                        bool has_font,
+                        UIGlyphAtlas *glyphs,
+                        int font_size,
+                        int text_padding,
                         Color text_color,
                         Color muted_color,
                         Color panel_color,
@@ -69,14 +70,12 @@ void ui_search_bar_draw(const UISearchBar *bar,
     DrawRectangleRec(rect, panel_color);
     DrawRectangleLinesEx(rect, 1.0f, border_color);
 
-    const int font_size = 18;
-    const int text_padding = 12;
     const char *text = (bar->text[0] != '\0') ? bar->text : "Search apps...";
     Color color = (bar->text[0] != '\0') ? text_color : muted_color;
     Vector2 pos = {rect.x + text_padding, rect.y + (rect.height - font_size) / 2.0f};
 
-    if (has_font)
-        DrawTextEx(font, text, pos, (float)font_size, 0.0f, color);
+    if (ui_glyph_atlas_ready(glyphs))
+        DrawTextEx(ui_glyph_atlas_text_font(glyphs, font_size, text), text, pos, (float)font_size, 0.0f, color);
     else
         DrawText(text, (int)pos.x, (int)pos.y, font_size, color);
 }
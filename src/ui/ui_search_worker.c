@@ -0,0 +1,287 @@
+#include "ui/ui_search_worker.h"
+#include "Trace.h"
+#include <string.h>
+
+#define SEARCH_SLOT_MASK 3
+#define SEARCH_SLOT_FRESH 4
+
+static gboolean lane_cancelled(gpointer user_data) {
+    UISearchLane *lane = (UISearchLane *)user_data;
+    UISearchWorker *worker = lane->worker;
+    return g_atomic_int_get(&worker->latest_serial) != lane->active_serial ||
+           (lane->provider->catalog && g_atomic_int_get(&worker->writer_waiting)) ||
+           g_get_monotonic_time() >= lane->deadline;
+}
+
+static void publish(UISearchLane *lane, gint serial, guint revision) {
+    UISearchResult *slot = &lane->slots[lane->back];
+    slot->serial = serial;
+    slot->revision = revision;
+
+    gint previous = g_atomic_int_exchange(&lane->ready, (gint)lane->back | SEARCH_SLOT_FRESH);
+    lane->back = (guint)previous & SEARCH_SLOT_MASK;
+}
+
+static void run_query(UISearchLane *lane, const char *query, gint serial) {
+    UISearchWorker *worker = lane->worker;
+    const UIProvider *provider = lane->provider;
+    lane->deadline = provider->timeout_us > 0 ? g_get_monotonic_time() + provider->timeout_us : G_MAXINT64;
+
+    for (;;) {
+        UIProviderResults *results = &lane->slots[lane->back].results;
+        ui_provider_results_reset(results);
+
+        if (provider->catalog)
+            g_rw_lock_reader_lock(&worker->catalog_lock);
+        gboolean done = provider->search(worker->data, lane->state, query, results, lane_cancelled, lane);
+        gboolean timed_out = !done && g_get_monotonic_time() >= lane->deadline &&
+                             g_atomic_int_get(&worker->latest_serial) == serial;
+        if (timed_out) {
+            trace_instant("search_timeout");
+            ui_provider_results_reset(results);
+        }
+        if (done || timed_out)
+            publish(lane, serial, provider->catalog ? provider->revision(worker->data) : 0);
+        if (provider->catalog)
+            g_rw_lock_reader_unlock(&worker->catalog_lock);
+
+        if (done || timed_out)
+            return;
+
+        g_mutex_lock(&worker->mutex);
+        while (!worker->quit && g_atomic_int_get(&worker->writer_waiting) &&
+               g_atomic_int_get(&worker->latest_serial) == serial) {
+            if (!g_cond_wait_until(&worker->cond, &worker->mutex, lane->deadline))
+                break;
+        }
+        gboolean retry = !worker->quit && g_atomic_int_get(&worker->latest_serial) == serial;
+        g_mutex_unlock(&worker->mutex);
+
+        if (!retry)
+            return;
+    }
+}
+
+static gpointer lane_thread(gpointer user_data) {
+    UISearchLane *lane = (UISearchLane *)user_data;
+    UISearchWorker *worker = lane->worker;
+
+    g_mutex_lock(&worker->mutex);
+    for (;;) {
+        while (!worker->quit && !lane->query)
+            g_cond_wait(&worker->cond, &worker->mutex);
+        if (worker->quit)
+            break;
+
+        char *query = lane->query;
+        gint serial = lane->query_serial;
+        lane->query = NULL;
+        lane->active_serial = serial;
+        g_mutex_unlock(&worker->mutex);
+
+        run_query(lane, query, serial);
+        g_free(query);
+
+        g_mutex_lock(&worker->mutex);
+    }
+    g_mutex_unlock(&worker->mutex);
+    return NULL;
+}
+
+static guint all_lanes(const UISearchWorker *worker) {
+    return (1u << worker->lane_count) - 1;
+}
+
+void ui_search_worker_init(UISearchWorker *worker, const UIAppData *data, guint providers) {
+    if (!worker)
+        return;
+
+    memset(worker, 0, sizeof(*worker));
+    g_mutex_init(&worker->mutex);
+    g_cond_init(&worker->cond);
+    g_rw_lock_init(&worker->catalog_lock);
+    worker->data = data;
+    worker->merged = g_array_sized_new(FALSE, FALSE, sizeof(UIAppResult), UI_APP_DATA_MAX_RESULTS);
+
+    for (guint kind = 0; kind < UI_PROVIDER_COUNT; kind++) {
+        const UIProvider *provider = ui_provider_get((UIProviderKind)kind);
+        if (!provider || !(providers & UI_PROVIDER_MASK(kind)))
+            continue;
+
+        UISearchLane *lane = &worker->lanes[worker->lane_count++];
+        lane->worker = worker;
+        lane->provider = provider;
+        lane->state = provider->state_new ? provider->state_new() : NULL;
+        for (guint i = 0; i < UI_SEARCH_WORKER_SLOTS; i++)
+            ui_provider_results_init(&lane->slots[i].results);
+        lane->ready = 1;
+        lane->back = 0;
+        lane->front = 2;
+        lane->thread = g_thread_new(provider->name, lane_thread, lane);
+    }
+    worker->merged_lanes = all_lanes(worker);
+}
+
+void ui_search_worker_free(UISearchWorker *worker) {
+    if (!worker || worker->lane_count == 0)
+        return;
+
+    g_mutex_lock(&worker->mutex);
+    worker->quit = TRUE;
+    g_atomic_int_inc(&worker->latest_serial);
+    g_cond_broadcast(&worker->cond);
+    g_mutex_unlock(&worker->mutex);
+
+    for (guint i = 0; i < worker->lane_count; i++) {
+        UISearchLane *lane = &worker->lanes[i];
+        g_thread_join(lane->thread);
+        lane->thread = NULL;
+        g_clear_pointer(&lane->query, g_free);
+        if (lane->state && lane->provider->state_free)
+            lane->provider->state_free(lane->state);
+        lane->state = NULL;
+        for (guint s = 0; s < UI_SEARCH_WORKER_SLOTS; s++)
+            ui_provider_results_clear(&lane->slots[s].results);
+    }
+    worker->lane_count = 0;
+
+    g_array_free(worker->merged, TRUE);
+    worker->merged = NULL;
+    g_rw_lock_clear(&worker->catalog_lock);
+    g_cond_clear(&worker->cond);
+    g_mutex_clear(&worker->mutex);
+}
+
+void ui_search_worker_submit(UISearchWorker *worker, const char *query) {
+    if (!worker || worker->lane_count == 0)
+        return;
+
+    const char *text = query ? query : "";
+    g_mutex_lock(&worker->mutex);
+    gint serial = g_atomic_int_add(&worker->latest_serial, 1) + 1;
+    for (guint i = 0; i < worker->lane_count; i++) {
+        UISearchLane *lane = &worker->lanes[i];
+        g_clear_pointer(&lane->query, g_free);
+        if (!lane->provider->accepts(text))
+            continue;
+
+        lane->query = g_strdup(text);
+        lane->query_serial = serial;
+        lane->accepted_serial = serial;
+    }
+    g_cond_broadcast(&worker->cond);
+    g_mutex_unlock(&worker->mutex);
+    worker->submitted_at = g_get_monotonic_time();
+}
+
+static bool lane_finished(const UISearchLane *lane, gint serial, const UIAppData *data) {
+    const UISearchResult *result = &lane->slots[lane->front];
+    return result->serial == serial && (!lane->provider->catalog || result->revision == lane->provider->revision(data));
+}
+
+static void merge_lanes(UISearchWorker *worker, guint lanes) {
+    guint cursor[UI_PROVIDER_COUNT] = {0};
+    g_array_set_size(worker->merged, 0);
+
+    while (worker->merged->len < UI_APP_DATA_MAX_RESULTS) {
+        const UIAppResult *best = NULL;
+        guint best_lane = 0;
+        for (guint i = 0; i < worker->lane_count; i++) {
+            if (!(lanes & (1u << i)))
+                continue;
+
+            const GArray *items = worker->lanes[i].slots[worker->lanes[i].front].results.items;
+            if (cursor[i] >= items->len)
+                continue;
+
+            const UIAppResult *head = &g_array_index(items, UIAppResult, cursor[i]);
+            if (!best || head->score > best->score) {
+                best = head;
+                best_lane = i;
+            }
+        }
+        if (!best)
+            break;
+
+        g_array_append_val(worker->merged, *best);
+        cursor[best_lane]++;
+    }
+}
+
+bool ui_search_worker_poll(UISearchWorker *worker, UIAppData *data) {
+    if (!worker || worker->lane_count == 0)
+        return false;
+
+    const gint serial = g_atomic_int_get(&worker->latest_serial);
+    const gint64 now = g_get_monotonic_time();
+    guint accepted = 0;
+    guint done = 0;
+    bool waiting = false;
+
+    for (guint i = 0; i < worker->lane_count; i++) {
+        UISearchLane *lane = &worker->lanes[i];
+        if (g_atomic_int_get(&lane->ready) & SEARCH_SLOT_FRESH) {
+            gint previous = g_atomic_int_exchange(&lane->ready, (gint)lane->front);
+            lane->front = (guint)previous & SEARCH_SLOT_MASK;
+        }
+
+        if (lane->accepted_serial != serial) {
+            done |= 1u << i;
+            continue;
+        }
+
+        accepted |= 1u << i;
+        if (lane_finished(lane, serial, data))
+            done |= 1u << i;
+        else if (now < worker->submitted_at + lane->provider->budget_us)
+            waiting = true;
+    }
+
+    if (waiting || (done != all_lanes(worker) && !(done & accepted)))
+        return false;
+    if (serial == worker->merged_serial && done == worker->merged_lanes)
+        return false;
+
+    merge_lanes(worker, done & accepted);
+    ui_app_data_set_results(data, (const UIAppResult *)(const void *)worker->merged->data, worker->merged->len);
+    worker->merged_serial = serial;
+    worker->merged_lanes = done;
+    return true;
+}
+
+bool ui_search_worker_pending(const UISearchWorker *worker) {
+    if (!worker || worker->lane_count == 0)
+        return false;
+    return g_atomic_int_get(&worker->latest_serial) != worker->merged_serial ||
+           worker->merged_lanes != all_lanes(worker);
+}
+
+bool ui_search_worker_lock_catalog(UISearchWorker *worker, bool wait) {
+    if (!worker || worker->lane_count == 0)
+        return true;
+
+    g_atomic_int_set(&worker->writer_waiting, 1);
+    if (wait) {
+        g_rw_lock_writer_lock(&worker->catalog_lock);
+        return true;
+    }
+    if (g_rw_lock_writer_trylock(&worker->catalog_lock))
+        return true;
+
+    g_mutex_lock(&worker->mutex);
+    g_atomic_int_set(&worker->writer_waiting, 0);
+    g_cond_broadcast(&worker->cond);
+    g_mutex_unlock(&worker->mutex);
+    return false;
+}
+
+void ui_search_worker_unlock_catalog(UISearchWorker *worker) {
+    if (!worker || worker->lane_count == 0)
+        return;
+
+    g_rw_lock_writer_unlock(&worker->catalog_lock);
+    g_mutex_lock(&worker->mutex);
+    g_atomic_int_set(&worker->writer_waiting, 0);
+    g_cond_broadcast(&worker->cond);
+    g_mutex_unlock(&worker->mutex);
+}
@@ -0,0 +1,70 @@
+#include "ui/ui_trace_overlay.h"
+#include <string.h>
+
+void ui_trace_overlay_init(UITraceOverlay *overlay) {
+    if (!overlay)
+        return;
+    memset(overlay, 0, sizeof(*overlay));
+}
+
+void ui_trace_overlay_input(UITraceOverlay *overlay, gint64 at) {
+    if (!overlay)
+        return;
+    if (overlay->input_at == 0 || at < overlay->input_at)
+        overlay->input_at = at;
+}
+
+void ui_trace_overlay_frame(UITraceOverlay *overlay, gint64 start, gint64 end) {
+    if (!overlay)
+        return;
+
+    overlay->frame_ms[overlay->frame_pos] = (float)(end - start) / 1000.0f;
+    overlay->frame_pos = (overlay->frame_pos + 1) % UI_TRACE_OVERLAY_SAMPLES;
+    if (overlay->frame_count < UI_TRACE_OVERLAY_SAMPLES)
+        overlay->frame_count++;
+
+    if (overlay->input_at != 0) {
+        overlay->latency_ms = (float)(end - overlay->input_at) / 1000.0f;
+        if (overlay->latency_ms > overlay->latency_max_ms)
+            overlay->latency_max_ms = overlay->latency_ms;
+        overlay->input_at = 0;
+    }
+}
+
+void ui_trace_overlay_draw(const UITraceOverlay *overlay,
+                           Rectangle bounds,
+                           UIGlyphAtlas *glyphs,
+                           Color text_color,
+                           Color panel_color) {
+    if (!overlay || overlay->frame_count == 0)
+        return;
+
+    float total = 0.0f;
+    float worst = 0.0f;
+    for (guint i = 0; i < overlay->frame_count; i++) {
+        total += overlay->frame_ms[i];
+        if (overlay->frame_ms[i] > worst)
+            worst = overlay->frame_ms[i];
+    }
+    guint last = (overlay->frame_pos + UI_TRACE_OVERLAY_SAMPLES - 1) % UI_TRACE_OVERLAY_SAMPLES;
+
+    char lines[2][96];
+    g_snprintf(lines[0], sizeof(lines[0]), "frame %.2f ms  avg %.2f  max %.2f",
+               overlay->frame_ms[last], total / overlay->frame_count, worst);
+    g_snprintf(lines[1], sizeof(lines[1]), "input->frame %.2f ms  max %.2f",
+               overlay->latency_ms, overlay->latency_max_ms);
+
+    const int font_size = 14;
+    const float line_height = font_size + 4.0f;
+    Rectangle panel = {bounds.x + bounds.width - 300.0f, bounds.y + bounds.height - line_height * 2 - 12.0f,
+                       300.0f, line_height * 2 + 12.0f};
+    DrawRectangleRec(panel, Fade(panel_color, 0.85f));
+
+    for (int i = 0; i < 2; i++) {
+        Vector2 pos = {panel.x + 8.0f, panel.y + 6.0f + line_height * i};
+        if (ui_glyph_atlas_ready(glyphs))
+            DrawTextEx(ui_glyph_atlas_text_font(glyphs, font_size, lines[i]), lines[i], pos, (float)font_size, 0.0f, text_color);
+        else
+            DrawText(lines[i], (int)pos.x, (int)pos.y, font_size, text_color);
+    }
+}
@@ -0,0 +1,117 @@
+#include "ui/ui_wakeup.h"
+#include <errno.h>
+#include <poll.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#if defined(WAYCAST_HAVE_GLFW_POST_EMPTY_EVENT)
+void glfwPostEmptyEvent(void);
+
+static void drain_control(int fd) {
+    uint64_t count = 0;
+    while (read(fd, &count, sizeof(count)) == (ssize_t)sizeof(count))
+        ;
+}
+
+static gpointer wakeup_thread(gpointer user_data) {
+    UIWakeup *wakeup = (UIWakeup *)user_data;
+    struct pollfd fds[UI_WAKEUP_MAX_FDS + 1];
+
+    g_mutex_lock(&wakeup->mutex);
+    for (;;) {
+        while (!wakeup->quit && !wakeup->armed)
+            g_cond_wait(&wakeup->cond, &wakeup->mutex);
+        if (wakeup->quit)
+            break;
+
+        nfds_t count = 0;
+        fds[count++] = (struct pollfd){.fd = wakeup->control_fd, .events = POLLIN};
+        for (guint i = 0; i < wakeup->fd_count; i++)
+            fds[count++] = (struct pollfd){.fd = wakeup->fds[i], .events = POLLIN};
+        g_mutex_unlock(&wakeup->mutex);
+
+        int ready = poll(fds, count, -1);
+        if (fds[0].revents & POLLIN)
+            drain_control(wakeup->control_fd);
+
+        g_mutex_lock(&wakeup->mutex);
+        bool fired = false;
+        for (nfds_t i = 1; ready > 0 && i < count; i++)
+            fired = fired || (fds[i].revents & (POLLIN | POLLHUP | POLLERR));
+        if (fired && wakeup->armed) {
+            wakeup->armed = FALSE;
+            glfwPostEmptyEvent();
+        }
+    }
+    g_mutex_unlock(&wakeup->mutex);
+    return NULL;
+}
+#endif
+
+static void signal_control(int fd) {
+    uint64_t one = 1;
+    if (fd >= 0 && write(fd, &one, sizeof(one)) != (ssize_t)sizeof(one) && errno != EAGAIN)
+        g_printerr("waycast: could not signal wakeup thread\n");
+}
+
+void ui_wakeup_init(UIWakeup *wakeup) {
+    if (!wakeup)
+        return;
+
+    memset(wakeup, 0, sizeof(*wakeup));
+    g_mutex_init(&wakeup->mutex);
+    g_cond_init(&wakeup->cond);
+    wakeup->control_fd = -1;
+#if defined(WAYCAST_HAVE_GLFW_POST_EMPTY_EVENT)
+    wakeup->control_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeup->control_fd >= 0)
+        wakeup->thread = g_thread_new("waycast-wakeup", wakeup_thread, wakeup);
+#endif
+}
+
+void ui_wakeup_free(UIWakeup *wakeup) {
+    if (!wakeup)
+        return;
+
+    if (wakeup->thread) {
+        g_mutex_lock(&wakeup->mutex);
+        wakeup->quit = TRUE;
+        g_cond_broadcast(&wakeup->cond);
+        g_mutex_unlock(&wakeup->mutex);
+        signal_control(wakeup->control_fd);
+        g_thread_join(wakeup->thread);
+        wakeup->thread = NULL;
+    }
+    if (wakeup->control_fd >= 0)
+        close(wakeup->control_fd);
+    wakeup->control_fd = -1;
+    g_cond_clear(&wakeup->cond);
+    g_mutex_clear(&wakeup->mutex);
+}
+
+bool ui_wakeup_arm(UIWakeup *wakeup, const int *fds, guint count) {
+    if (!wakeup || !wakeup->thread)
+        return false;
+
+    g_mutex_lock(&wakeup->mutex);
+    wakeup->fd_count = MIN(count, (guint)UI_WAKEUP_MAX_FDS);
+    memcpy(wakeup->fds, fds, wakeup->fd_count * sizeof(int));
+    wakeup->armed = wakeup->fd_count > 0;
+    g_cond_broadcast(&wakeup->cond);
+    g_mutex_unlock(&wakeup->mutex);
+    return true;
+}
+
+void ui_wakeup_disarm(UIWakeup *wakeup) {
+    if (!wakeup || !wakeup->thread)
+        return;
+
+    g_mutex_lock(&wakeup->mutex);
+    bool was_armed = wakeup->armed;
+    wakeup->armed = FALSE;
+    g_mutex_unlock(&wakeup->mutex);
+    if (was_armed)
+        signal_control(wakeup->control_fd);
+}